@@ -0,0 +1,85 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <utility>
+#include <vector>
+
+/// \brief helpers shared by the benchmarks, which all output csv lines with a
+/// header so that runs of different builds can be diffed or joined
+namespace bench {
+using clock = std::chrono::steady_clock;
+
+/// \return nanoseconds per operation of running fn once, which does n_ops
+template <typename Fn> double ns_per_op(long n_ops, Fn &&fn) {
+    const auto start = clock::now();
+    fn();
+    const std::chrono::duration<double, std::nano> elapsed =
+        clock::now() - start;
+    return elapsed.count() / n_ops;
+}
+
+/// \return milliseconds taken by running fn once
+template <typename Fn> double ms(Fn &&fn) { return ns_per_op(1, fn) / 1e6; }
+
+/// \return the result of fn and the milliseconds it took
+template <typename Fn> auto timed(Fn &&fn) {
+    const auto start = clock::now();
+    auto result = fn();
+    const std::chrono::duration<double, std::milli> elapsed =
+        clock::now() - start;
+    return std::make_pair(std::move(result), elapsed.count());
+}
+
+/// \return microseconds taken by each call of fn(i) for i in [0, n)
+template <typename Fn> std::vector<double> latencies(int n, Fn &&fn) {
+    std::vector<double> us(n);
+    for (int i = 0; i < n; ++i)
+        us[i] = ns_per_op(1, [&] { fn(i); }) / 1e3;
+    return us;
+}
+
+/// \return the p-th percentile (p in [0, 100]) of samples by nearest rank,
+/// 0 if there are none
+inline double percentile(std::vector<double> samples, double p) {
+    if (samples.empty())
+        return 0;
+    const auto rank = static_cast<std::size_t>(
+        std::ceil(p / 100 * samples.size()));
+    const auto nth = std::begin(samples) + std::max<std::size_t>(rank, 1) - 1;
+    std::nth_element(std::begin(samples), nth, std::end(samples));
+    return *nth;
+}
+
+/// \brief hold model of the priority queues: the queue is filled with random
+/// priorities in [0, span], then each hold pops the top and pushes it back a
+/// random distance further, which is monotone like Dijkstra's algorithm.
+/// filling and holding are apart so that only the holds are measured
+template <typename Queue> struct hold {
+    Queue &q;                                ///< queue held
+    std::mt19937 gen{42};                    ///< same draws for every queue
+    std::uniform_int_distribution<int> incr; ///< distance of each push
+
+    hold(Queue &q, int n_items, int span) : q(q), incr(0, span) {
+        for (int u = 0; u < n_items; ++u)
+            q.push(u, incr(gen));
+    }
+
+    /// \return sum of the items popped by n_holds holds
+    long operator()(int n_holds) {
+        long checksum = 0;
+        for (int i = 0; i < n_holds; ++i) {
+            auto [u, p] = q.top();
+            q.pop();
+            q.push(u, p + incr(gen));
+            checksum += u;
+        }
+        return checksum;
+    }
+};
+} // namespace bench
+
+#endif /* BENCH_H */
@@ -0,0 +1,37 @@
+#include "bench.hpp"
+#include "delta_stepping.hpp"
+
+/// \brief scaling of delta-stepping over 1..N threads on a random graph, for
+/// a few bucket widths. outputs csv lines
+int main(int, char const *[]) {
+    const int n_vertices = 20000, n_sources = 8;
+    const CsrGraph csr = Graph{n_vertices, 10.0 / n_vertices, 42}.freeze();
+
+    // powers of two up to all the hardware threads
+    const unsigned max_threads =
+        std::max(std::thread::hardware_concurrency(), 1u);
+    std::vector<unsigned> threads;
+    for (unsigned n_threads = 1; n_threads < max_threads; n_threads *= 2)
+        threads.push_back(n_threads);
+    threads.push_back(max_threads);
+
+    std::cout << "benchmark,delta,threads,vertices,edges,ms_per_query,"
+                 "speedup\n";
+    for (int delta : {1, 0, 500}) {
+        double single = 0;
+        for (const auto &n_threads : threads) {
+            DeltaStepping ds{csr, delta, n_threads};
+            const double ms = bench::ms([&] {
+                                  for (int s = 0; s < n_sources; ++s)
+                                      ds.distances(csr.identity(s * 97));
+                              }) /
+                              n_sources;
+            if (n_threads == 1)
+                single = ms;
+            std::cout << "delta_stepping," << ds.width() << "," << n_threads
+                      << "," << csr.order() << "," << csr.size() << "," << ms
+                      << "," << single / ms << "\n";
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,44 @@
+#include "bench.hpp"
+#include "csr_graph.hpp"
+
+/// \brief cost of building graphs: generating random ones across vertex
+/// counts and average degrees, loading the algs4 files given as arguments and
+/// freezing both into snapshots. outputs csv lines
+int main(int argc, char const *argv[]) {
+    std::cout << "benchmark,graph,vertices,edges,ms\n";
+    const auto report = [](const char *benchmark, const std::string &name,
+                           int order, int size, double ms) {
+        std::cout << benchmark << "," << name << "," << order << "," << size
+                  << "," << ms << "\n";
+    };
+    // reports the freezing and returns the number of edges
+    const auto freeze = [&report](const Graph &g, const std::string &name) {
+        const auto [csr, ms] = bench::timed([&g] { return g.freeze(); });
+        report("freeze", name, csr.order(), csr.size(), ms);
+        return csr.size();
+    };
+
+    for (int n_vertices : {1000, 10000, 100000}) {
+        for (int degree : {4, 16, 64}) {
+            if (1l * n_vertices * degree > 1e7) // keep the suite short
+                continue;
+            const std::string name = "random_d" + std::to_string(degree);
+            const auto [g, ms] = bench::timed([&] {
+                return Graph{n_vertices, double(degree) / n_vertices, 42};
+            });
+            report("generate", name, g.order(), freeze(g, name), ms);
+        }
+    }
+
+    for (int i = 1; i < argc; ++i) {
+        try {
+            const auto [g, ms] =
+                bench::timed([&] { return Graph::load_algs4(argv[i]); });
+            report("load_algs4", argv[i], g.order(), freeze(g, argv[i]), ms);
+        } catch (const std::exception &e) {
+            std::cerr << argv[i] << ": " << e.what() << "\n";
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,55 @@
+#include "bench.hpp"
+#include "short_path.hpp"
+
+/// \brief benchmarks of the priority queues, both in isolation using the hold
+/// model (pop the top then push it back a random distance further, which is
+/// monotone like Dijkstra's algorithm) and driving Dijkstra's algorithm on
+/// snapshots of random graphs. outputs csv lines
+namespace {
+using bench::ns_per_op;
+
+/// \return nanoseconds per hold of q, see bench::hold
+template <typename Queue>
+double hold(Queue &&q, int n_items, int n_holds, int span) {
+    bench::hold<Queue> holds{q, n_items, span};
+    return ns_per_op(n_holds, [&] { holds(n_holds); });
+}
+
+double queries(const CsrGraph &csr, Dijkstra::queue kind, int n_queries) {
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<int> verts(0, csr.order() - 1);
+    long checksum = 0;
+    const double ns = ns_per_op(n_queries, [&] {
+        for (int i = 0; i < n_queries; ++i)
+            checksum += Dijkstra::find_path(csr, csr.identity(verts(gen)),
+                                            csr.identity(verts(gen)), kind)
+                            .cost();
+    });
+    return checksum >= 0 ? ns : -1; // keep the queries from being elided
+}
+} // namespace
+
+int main(int, char const *[]) {
+    const int span = 500, n_holds = 1 << 20;
+
+    std::cout << "benchmark,queue,size,ns_per_op\n";
+    for (int n_items : {1 << 10, 1 << 14, 1 << 18}) {
+        std::cout << "hold,binary_heap," << n_items << ","
+                  << hold(DaryPQ<2>(n_items), n_items, n_holds, span) << "\n";
+        std::cout << "hold,4ary_heap," << n_items << ","
+                  << hold(PQ(n_items), n_items, n_holds, span) << "\n";
+        std::cout << "hold,bucket," << n_items << ","
+                  << hold(BucketPQ(span, n_items), n_items, n_holds, span)
+                  << "\n";
+    }
+
+    for (int n_vertices : {500, 2000, 8000}) {
+        const CsrGraph csr = Graph{n_vertices, 20.0 / n_vertices, 42}.freeze();
+        const int n_queries = 2e6 / n_vertices;
+        std::cout << "dijkstra,heap," << n_vertices << ","
+                  << queries(csr, Dijkstra::queue::heap, n_queries) << "\n";
+        std::cout << "dijkstra,bucket," << n_vertices << ","
+                  << queries(csr, Dijkstra::queue::bucket, n_queries) << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,116 @@
+#include "bench.hpp"
+#include "short_path.hpp"
+
+/// \brief hardware counters (cycles, instructions, last level cache misses
+/// and branch misses) of building graphs, of the priority queues alone and of
+/// the phases of the queries, on a random graph and on the algs4 files given
+/// as arguments. outputs csv lines, with empty counters when the system does
+/// not provide them
+namespace {
+PerfCounters counters;
+
+/// \brief prints one line, ops being how many operations the counts cover
+void report(const std::string &graph, const std::string &phase, long ops,
+            const PerfCounters::sample &counts) {
+    std::cout << graph << "," << phase << "," << ops;
+    for (int e = 0; e < PerfCounters::n_events; ++e) {
+        std::cout << ",";
+        if (counters.has(PerfCounters::event(e)))
+            std::cout << counts[e];
+    }
+    std::cout << ",";
+    if (counts[PerfCounters::cycles] > 0)
+        std::cout << double(counts[PerfCounters::instructions]) /
+                         counts[PerfCounters::cycles];
+    std::cout << "\n";
+}
+
+/// \return the counts of running fn once, and its result
+template <typename Fn> auto measure(Fn &&fn) {
+    const auto before = counters.read();
+    auto result = fn();
+    auto counts = counters.read();
+    for (int e = 0; e < PerfCounters::n_events; ++e)
+        counts[e] -= before[e];
+    return std::make_pair(std::move(result), counts);
+}
+
+/// \return the counts of n_holds holds of q, see bench::hold
+template <typename Queue>
+PerfCounters::sample hold(Queue &&q, int n_items, int n_holds) {
+    bench::hold<Queue> holds{q, n_items, 500};
+    return measure([&] { return holds(n_holds); }).second;
+}
+
+/// \brief the phases of n_queries random queries, on the graph then on its
+/// snapshot with both queues
+void queries(const Graph &g, const std::string &name, int n_queries) {
+    const auto frozen = measure([&g] { return g.freeze(); });
+    const CsrGraph &csr = frozen.first;
+    report(name, "freeze", csr.size(), frozen.second);
+
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<int> verts(0, g.order() - 1);
+    std::vector<std::pair<vertex_id, vertex_id>> pairs(n_queries);
+    for (auto &[source, sink] : pairs)
+        source = g.identity(verts(gen)), sink = g.identity(verts(gen));
+
+    const char *phases[] = {"init", "search", "trace"};
+    const auto run = [&](const std::string &variant, auto find_path) {
+        search_stats stats;
+        stats.perf = &counters;
+        for (const auto &[source, sink] : pairs)
+            find_path(source, sink, &stats);
+        for (int p = 0; p < search_stats::n_phases; ++p)
+            report(name, variant + "_" + phases[p],
+                   p == search_stats::search ? stats.scanned : n_queries,
+                   stats.events[p]);
+    };
+    Dijkstra algo{g};
+    run("graph", [&](auto u, auto v, auto stats) {
+        return algo.find_path(u, v, stats);
+    });
+    run("csr_heap", [&](auto u, auto v, auto stats) {
+        return Dijkstra::find_path(csr, u, v, Dijkstra::queue::heap, stats);
+    });
+    if (csr.min_weight() >= 0 and csr.max_weight() <= Dijkstra::max_bucket_span)
+        run("csr_bucket", [&](auto u, auto v, auto stats) {
+            return Dijkstra::find_path(csr, u, v, Dijkstra::queue::bucket,
+                                       stats);
+        });
+}
+} // namespace
+
+int main(int argc, char const *argv[]) {
+    if (not counters.available())
+        std::cerr << "hardware counters are not available, check "
+                     "/proc/sys/kernel/perf_event_paranoid\n";
+
+    std::cout << "graph,phase,ops,cycles,instructions,llc_misses,"
+                 "branch_misses,ipc\n";
+    const int n_items = 1 << 16, n_holds = 1 << 20;
+    report("-", "hold_4ary_heap", n_holds,
+           hold(PQ(n_items), n_items, n_holds));
+    report("-", "hold_bucket", n_holds,
+           hold(BucketPQ(500, n_items), n_items, n_holds));
+
+    const int n_vertices = 100000, n_queries = 100;
+    auto [g, generating] = measure(
+        [] { return Graph{n_vertices, 8.0 / n_vertices, 42}; });
+    report("random_d8", "generate", n_vertices, generating);
+    queries(g, "random_d8", n_queries);
+
+    for (int i = 1; i < argc; ++i) {
+        try {
+            auto [g, loading] =
+                measure([&] { return Graph::load_algs4(argv[i]); });
+            report(argv[i], "load_algs4", g.order(), loading);
+            if (g.order() > 0)
+                queries(g, argv[i], n_queries);
+        } catch (const std::exception &e) {
+            std::cerr << argv[i] << ": " << e.what() << "\n";
+            return 1;
+        }
+    }
+    return 0;
+}
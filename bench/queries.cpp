@@ -0,0 +1,83 @@
+#include "bench.hpp"
+#include "short_path.hpp"
+
+#include <functional>
+
+/// \brief latency distribution of point to point queries, for every Dijkstra
+/// variant on random graphs and on the algs4 files given as arguments. the
+/// checksum sums the costs found, so it should not change between builds
+namespace {
+/// \brief runs the same random pairs through every variant and prints one
+/// line per variant
+void queries(const Graph &g, const std::string &name, int n_queries) {
+    Dijkstra algo{g};
+    const CsrGraph csr = g.freeze();
+
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<int> verts(0, g.order() - 1);
+    std::vector<std::pair<vertex_id, vertex_id>> pairs(n_queries);
+    for (auto &[source, sink] : pairs)
+        source = g.identity(verts(gen)), sink = g.identity(verts(gen));
+
+    using variant = std::function<path(vertex_id, vertex_id)>;
+    std::vector<std::pair<const char *, variant>> variants = {
+        {"graph", [&](auto u, auto v) { return algo.find_path(u, v); }},
+        {"graph_lazy",
+         [&](auto u, auto v) { return algo.find_path_lazy(u, v); }},
+        {"graph_bidirectional",
+         [&](auto u, auto v) { return algo.find_path_bidirectional(u, v); }},
+        {"csr_heap", [&](auto u, auto v) {
+             return Dijkstra::find_path(csr, u, v, Dijkstra::queue::heap);
+         }}};
+    if (csr.min_weight() >= 0 and csr.max_weight() <= Dijkstra::max_bucket_span)
+        variants.push_back({"csr_bucket", [&](auto u, auto v) {
+                                return Dijkstra::find_path(
+                                    csr, u, v, Dijkstra::queue::bucket);
+                            }});
+
+    for (const auto &[variant, find_path] : variants) {
+        long checksum = 0;
+        const auto &us = bench::latencies(n_queries, [&](int i) {
+            checksum += find_path(pairs[i].first, pairs[i].second).cost();
+        });
+        double total = 0;
+        for (const auto &t : us)
+            total += t;
+        std::cout << name << "," << g.order() << "," << csr.size() << ","
+                  << variant << "," << n_queries << "," << total / n_queries
+                  << "," << bench::percentile(us, 50) << ","
+                  << bench::percentile(us, 90) << ","
+                  << bench::percentile(us, 99) << ","
+                  << bench::percentile(us, 100) << "," << checksum << "\n";
+    }
+}
+
+/// \return number of queries so that each variant runs for a similar time
+int n_queries_for(int n_edges) {
+    return std::clamp(static_cast<int>(2e7 / std::max(n_edges, 1)), 20, 1000);
+}
+} // namespace
+
+int main(int argc, char const *argv[]) {
+    std::cout << "graph,vertices,edges,variant,queries,mean_us,p50_us,p90_us,"
+                 "p99_us,max_us,checksum\n";
+    for (int n_vertices : {1000, 10000, 100000}) {
+        for (int degree : {4, 16}) {
+            const Graph g{n_vertices, double(degree) / n_vertices, 42};
+            queries(g, "random_d" + std::to_string(degree),
+                    n_queries_for(n_vertices * degree));
+        }
+    }
+
+    for (int i = 1; i < argc; ++i) {
+        try {
+            const Graph g = Graph::load_algs4(argv[i]);
+            if (g.order() > 0)
+                queries(g, argv[i], n_queries_for(g.freeze().size()));
+        } catch (const std::exception &e) {
+            std::cerr << argv[i] << ": " << e.what() << "\n";
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,82 @@
+#ifndef ALL_PAIRS_H
+#define ALL_PAIRS_H
+
+#include "short_path.hpp"
+#include "thread_pool.hpp"
+
+#include <limits>
+
+/// \brief all pairs shortest paths of a graph kept in a flat distance matrix
+///
+/// dense graphs are solved with a cache blocked Floyd-Warshall: the matrix is
+/// split into tiles small enough to stay in cache, each round updates the
+/// diagonal tile, then the tiles of its row and column, then all the others,
+/// the tiles of a phase being independent they are spread over a thread pool.
+/// the min-plus inner loops are branch free over contiguous rows so that the
+/// compiler vectorizes them. sparse graphs fall back to one Dijkstra's search
+/// per source, also in parallel. an optional next-hop matrix allows
+/// extracting the paths themselves
+class AllPairs {
+  public:
+    /// \brief distance of unreachable pairs, small enough to be summed twice
+    static constexpr int inf = std::numeric_limits<int>::max() / 2;
+
+    /// \brief algorithm filling the matrix
+    enum class method {
+        automatic,      ///< picked from the density of the graph
+        floyd_warshall, ///< cache blocked Floyd-Warshall
+        dijkstra,       ///< one Dijkstra's search per source
+    };
+
+    static constexpr int block = 64; ///< side of the tiles of the matrix
+
+  private:
+    std::vector<vertex_id> _ids;      ///< dense index to vertex id, sorted
+    int n = 0;                        ///< number of vertices
+    int stride = 0;                   ///< n padded to a multiple of block
+    std::vector<int> _dist;           ///< distance i -> j at i * stride + j
+    std::vector<int> _next;           ///< first hop of i -> j if kept
+    method _used = method::automatic; ///< the method that filled the matrix
+
+    void floyd_warshall(ThreadPool &pool);
+    void dijkstra(const CsrGraph &csr, ThreadPool &pool);
+
+    int index(vertex_id u) const; ///< dense index of u, throws if not found
+
+  public:
+    /// \brief computes the distances between every pair of vertices
+    ///
+    /// \param graph graph to solve, edge weights should be non-negative
+    /// \param next_hops if true, the paths can be extracted with find_path()
+    /// \param how algorithm to use, by default Dijkstra's algorithm is used
+    /// for sparse graphs and Floyd-Warshall for dense ones
+    /// \param n_threads number of threads sharing the work
+    explicit AllPairs(const Graph &graph, bool next_hops = false,
+                      method how = method::automatic,
+                      unsigned n_threads = std::thread::hardware_concurrency());
+
+    int order() const noexcept { return n; }       ///< number of vertices
+    method used() const noexcept { return _used; } ///< method that was used
+
+    /// \return true if there is a path from u to v
+    bool reachable(vertex_id u, vertex_id v) const;
+
+    /// \return path cost from u to v, throws if v is unreachable from u
+    int cost(vertex_id u, vertex_id v) const;
+
+    /// \brief follows the next hops from the source to the sink, throws if
+    /// they were not kept or if either vertex is not found
+    ///
+    /// \param source vertex to go from
+    /// \param sink vertex to go to
+    /// \return a path, if not path is found default is returned
+    path find_path(vertex_id source, vertex_id sink) const;
+
+    /// \brief row of the distances from the dense index i, stride long
+    const int *row(int i) const noexcept { return &_dist[i * stride]; }
+
+    /// \brief testing all class functions
+    static void unit_testing() noexcept;
+};
+
+#endif /* ALL_PAIRS_H */
@@ -0,0 +1,77 @@
+#ifndef ALT_H
+#define ALT_H
+
+#include "short_path.hpp"
+
+#include <limits>
+
+/// \brief goal directed shortest paths using A*, landmarks and the triangle
+/// inequality (ALT)
+///
+/// an offline step picks k landmarks and stores the distances from and to
+/// each of them for every vertex. for any vertex v, target t and landmark L,
+/// the triangle inequality gives d(v, t) >= d(v, L) - d(t, L) and
+/// d(v, t) >= d(L, t) - d(L, v), the best of these bounds drives A* toward
+/// the target so that queries settle a fraction of the vertices Dijkstra's
+/// algorithm would. the landmark tables can be saved and loaded to pay the
+/// preprocessing only once per graph
+class Alt {
+    /// \brief distance of unreachable vertices
+    static constexpr int inf = std::numeric_limits<int>::max();
+
+    const CsrGraph &g;           ///< snapshot the tables were computed on
+    int k = 0;                   ///< number of landmarks
+    std::vector<int> _landmarks; ///< dense indices of the landmarks
+    std::vector<int> _from;      ///< d(L, v) at v * k + L
+    std::vector<int> _to;        ///< d(v, L) at v * k + L
+
+  public:
+    /// \brief picks the landmarks and computes their tables. the first
+    /// landmark is the lowest vertex, each next one is the vertex furthest
+    /// from all the landmarks picked so far, preferring unreachable ones to
+    /// cover every component
+    ///
+    /// \param csr snapshot in which we would operate, should outlive this
+    /// \param n_landmarks number of landmarks, capped to the number of
+    /// vertices
+    Alt(const CsrGraph &csr, int n_landmarks);
+
+    /// \brief loads the tables previously saved for the same snapshot, throws
+    /// if the stream is corrupt or was saved for a different graph. landmarks
+    /// should be vertices at distance 0 of themselves, and distances should
+    /// not be negative
+    ///
+    /// \param csr snapshot in which we would operate, should outlive this
+    /// \param in stream to read from, should be opened in binary mode
+    Alt(const CsrGraph &csr, std::istream &in);
+
+    /// \brief writes the landmark tables in a binary format, see Alt(csr, in)
+    ///
+    /// \param out stream to write to, should be opened in binary mode
+    void save(std::ostream &out) const;
+
+    /// \return vertex ids of the landmarks
+    std::vector<vertex_id> landmarks() const;
+
+    /// \brief lower bound of the distance between two vertices
+    ///
+    /// \param u dense index of the vertex we're going from
+    /// \param t dense index of the vertex we're going to
+    /// \return the best bound given by the landmarks, 0 if none applies and
+    /// inf if they prove t unreachable from u
+    int lower_bound(int u, int t) const;
+
+    /// \brief finds a path the source and the sink using A*, throws if either
+    /// is not found in the graph. the search state is the workspace of the
+    /// thread, see Dijkstra::workspace
+    ///
+    /// \param source vertex to go from
+    /// \param sink vertex to go to
+    /// \return a path, if not path is found default is returned
+    path find_path(vertex_id source, vertex_id sink) const;
+
+    /// \brief testing all class functions
+    static void unit_testing() noexcept;
+};
+
+#endif /* ALT_H */
@@ -0,0 +1,211 @@
+#ifndef BUCKET_PQ_H
+#define BUCKET_PQ_H
+
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+/// \brief Monotone integer Priority Queue using Dial's buckets
+///
+/// when priorities are integers and every pushed priority lies within
+/// [top, top + span] of the last popped one (which is the case in Dijkstra's
+/// algorithm with integer weights bounded by span), items can be kept in a
+/// circular array of span + 1 buckets indexed by priority. push() and
+/// change_priority() are then O(1) and pop() amortizes to O(1) plus the empty
+/// buckets it skips, no comparisons involved. it follows the same interface as
+/// PQ so both can be swapped in templated code. values are used as indices,
+/// hence they should be non-negative and preferably dense
+class BucketPQ {
+  public:
+    /// \brief each item in the priority queue is a pair of value and priority
+    using item = std::pair</* value */ int, /* priority */ int>;
+
+  private:
+    static constexpr int npos = -1; ///< end of a bucket list
+
+    /// \brief every value is linked in the bucket of its priority, keeping the
+    /// links in flat arrays indexed by value avoids allocating per bucket
+    struct link_t {
+        int prev = npos, next = npos; ///< neighbors in the bucket list
+        int prio = 0;                 ///< priority of the value
+        bool queued = false;          ///< whether the value is in the queue
+    };
+
+    std::vector<int> heads;    ///< first value of each bucket by priority
+    std::vector<link_t> links; ///< value to its links
+    int cursor = 0;            ///< lowest priority that may still be queued
+    int n_items = 0;           ///< number of queued items
+
+    int &head(int priority) { return heads[priority % heads.size()]; }
+
+    /// \brief pushes the value at the front of its priority's bucket
+    void link(int u) {
+        auto &l = links[u];
+        l.prev = npos, l.next = head(l.prio);
+        if (l.next != npos)
+            links[l.next].prev = u;
+        head(l.prio) = u;
+    }
+
+    /// \brief removes the value from its priority's bucket
+    void unlink(int u) {
+        const auto &l = links[u];
+        if (l.prev != npos)
+            links[l.prev].next = l.next;
+        else
+            head(l.prio) = l.next;
+        if (l.next != npos)
+            links[l.next].prev = l.prev;
+    }
+
+    /// \brief checks that priority is in the window the buckets can hold
+    void window_check(int u, int priority) const {
+        if (priority < cursor or
+            priority - cursor >= static_cast<int>(heads.size()))
+            throw std::out_of_range("priority " + std::to_string(priority) +
+                                    " of " + std::to_string(u) +
+                                    " is out of the monotone window");
+    }
+
+    /// \brief advances the cursor to the first non-empty bucket
+    void settle() {
+        while (head(cursor) == npos)
+            ++cursor;
+    }
+
+  public:
+    /// \brief constructor of the queue
+    ///
+    /// \param span the maximum difference between any queued priority and
+    /// the top, that is the maximum edge weight for Dijkstra's algorithm
+    /// \param capacity expected upper bound of values
+    explicit BucketPQ(int span, int capacity = 0) {
+        if (span < 0)
+            throw std::runtime_error("negative span");
+        heads.resize(span + 1, npos);
+        reserve(capacity);
+    }
+
+    /// \brief reserve room for values in the range [0, capacity)
+    void reserve(int capacity) {
+        if (capacity > static_cast<int>(links.size()))
+            links.resize(capacity);
+    }
+
+    /// \brief pushing an new unique item to the priority queue, throws if the
+    /// items exists beforehand or if the priority is out of the window
+    ///
+    /// \param u item's value
+    /// \param priority item's priority
+    void push(int u, int priority) {
+        if (u < 0)
+            throw std::out_of_range(std::to_string(u) + " is negative");
+        if (contains(u))
+            throw std::runtime_error(std::to_string(u) + " already exists");
+        window_check(u, priority);
+        if (u >= static_cast<int>(links.size()))
+            reserve(std::max<std::size_t>(u + 1, links.size() * 2));
+        links[u].prio = priority, links[u].queued = true;
+        link(u);
+        ++n_items;
+    }
+
+    /// \brief changes the priority of an existing item, throws if not or if
+    /// the priority is out of the window
+    ///
+    /// \param u exciting item's value
+    /// \param priority new priority
+    void change_priority(int u, int priority) {
+        if (not contains(u))
+            throw std::out_of_range(std::to_string(u) + " doesn't exist");
+        window_check(u, priority);
+        unlink(u);
+        links[u].prio = priority;
+        link(u);
+    }
+
+    /// \brief removes the top item from the priority queue, throws if empty
+    void pop() {
+        if (empty())
+            throw std::runtime_error("Empty priority queue");
+        settle();
+        const int u = head(cursor);
+        unlink(u);
+        links[u].queued = false;
+        --n_items;
+    }
+
+    /// \brief get the item with top priority, non const since it moves the
+    /// cursor past the empty buckets
+    ///
+    /// \return item at top
+    item top() {
+        if (empty())
+            throw std::runtime_error("Empty priority queue");
+        settle();
+        const int u = head(cursor);
+        return {u, links[u].prio};
+    }
+
+    /// \brief removes all items and moves the window back to priority 0. a
+    /// few items left are unlinked one by one, many are dropped by sweeping
+    /// all links in order, which beats chasing the lists across memory
+    void clear() noexcept {
+        if (n_items > static_cast<int>(links.size() / 16)) {
+            for (auto &l : links)
+                l.queued = false;
+            std::fill(std::begin(heads), std::end(heads), npos);
+            n_items = 0;
+        }
+        for (unsigned b = 0; n_items > 0 and b < heads.size(); ++b) {
+            for (int u = heads[b]; u != npos; u = links[u].next)
+                links[u].queued = false, --n_items;
+            heads[b] = npos;
+        }
+        cursor = 0;
+    }
+
+    /// \return the maximum difference between any queued priority and the top
+    int span() const noexcept { return heads.size() - 1; }
+
+    /// \return true if item's value is found, false otherwise
+    bool contains(int u) const noexcept {
+        return u >= 0 and u < static_cast<int>(links.size()) and
+               links[u].queued;
+    }
+
+    /// \return true is empty, false otherwise
+    bool empty() const noexcept { return n_items == 0; }
+
+    /// \brief
+    int size() const noexcept { return n_items; }
+
+    /// \brief unit testing for all functions of the class
+    static void unit_testing() noexcept {
+        std::cout << " ----------- Testing Bucket Queue ---------------\n";
+        BucketPQ q(10);
+
+        for (auto loop = 0; loop < 10; ++loop)
+            q.push(loop, 10 - loop);
+        for (auto loop = 0; loop < 10; loop += 2)
+            q.change_priority(loop, 1 + loop / 2);
+        try {
+            q.push(10, 11);
+        } catch (const std::out_of_range &e) {
+            std::cout << e.what() << std::endl;
+        }
+
+        while (not q.empty()) {
+            auto [u, p] = q.top();
+            std::cout << "removing: " << u << " " << p << std::endl;
+            q.pop();
+            if (u == 0) // priorities may wrap around the buckets
+                q.push(20, p + 10);
+        }
+    }
+};
+
+#endif /* BUCKET_PQ_H */
@@ -0,0 +1,68 @@
+#ifndef CONTRACTION_H
+#define CONTRACTION_H
+
+#include "short_path.hpp"
+
+#include <limits>
+
+/// \brief Contraction Hierarchies over a snapshot of a static graph
+///
+/// preprocessing contracts the vertices one by one, least important first,
+/// where contracting v removes it and adds a shortcut u -> w for every pair of
+/// neighbors whose shortest path goes through v and has no witness path
+/// avoiding it. vertices are ranked by their contraction order and a query is
+/// a bidirectional Dijkstra that only goes upward in rank, forward from the
+/// source and backward from the sink, settling a tiny fraction of the graph.
+/// shortcuts remember the vertex they bypass so that paths are unpacked back
+/// to the original vertices
+class ContractionHierarchy {
+    /// \brief distance of unreachable vertices
+    static constexpr int inf = std::numeric_limits<int>::max();
+
+    /// \brief an edge to or from a higher ranked vertex
+    struct arc {
+        int target;        ///< dense index of the other end of the edge
+        edge_weight_t wei; ///< weight of the edge, or of the bypassed path
+        int mid;           ///< bypassed vertex of shortcuts, -1 otherwise
+    };
+
+    const CsrGraph &g;              ///< snapshot the hierarchy was built of
+    std::vector<int> _rank;         ///< dense index to contraction order
+    std::vector<int> _up_offsets;   ///< V + 1 offsets into _up
+    std::vector<arc> _up;           ///< v -> target, target ranked above v
+    std::vector<int> _down_offsets; ///< V + 1 offsets into _down
+    std::vector<arc> _down;         ///< target -> v, target ranked above v
+    int _shortcuts = 0;             ///< number of shortcuts added
+
+    /// \brief appends the original vertices of the edge from -> to, which
+    /// bypasses mid if it is a shortcut, to verts. from itself is not appended
+    void unpack(int from, int to, int mid, std::vector<vertex_id> &verts) const;
+
+  public:
+    /// \brief contracts all vertices of the snapshot. vertices are ordered
+    /// lazily by their edge difference (shortcuts added minus edges removed)
+    /// plus their contracted neighbors, to contract uniformly across the graph
+    ///
+    /// \param csr snapshot in which we would operate, should outlive this
+    explicit ContractionHierarchy(const CsrGraph &csr);
+
+    /// \return number of shortcuts added by the contraction
+    int shortcuts() const noexcept { return _shortcuts; }
+
+    /// \return contraction order of vertex u, throws if not found
+    int rank(vertex_id u) const;
+
+    /// \brief finds a path the source and the sink using an upward
+    /// bidirectional search, throws if either is not found in the graph. the
+    /// directions run in the workspaces of the thread, see Dijkstra::workspace
+    ///
+    /// \param source vertex to go from
+    /// \param sink vertex to go to
+    /// \return a path, if not path is found default is returned
+    path find_path(vertex_id source, vertex_id sink) const;
+
+    /// \brief testing all class functions
+    static void unit_testing() noexcept;
+};
+
+#endif /* CONTRACTION_H */
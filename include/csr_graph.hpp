@@ -0,0 +1,148 @@
+#ifndef CSR_GRAPH_H
+#define CSR_GRAPH_H
+
+#include "graph.hpp"
+
+/// \brief read only array that either owns its elements or views memory owned
+/// by someone else, such as a file mapped in memory
+template <typename T> class flat_array {
+    std::vector<T> owned;     ///< elements, if owned
+    const T *items = nullptr; ///< first element, owned or not
+    std::size_t n = 0;        ///< number of elements
+
+  public:
+    flat_array() = default; ///< default array is empty
+
+    /// \brief takes ownership of the elements
+    flat_array(std::vector<T> elems)
+        : owned(std::move(elems)), items(owned.data()), n(owned.size()) {}
+
+    /// \brief views n elements starting at data, which should outlive this
+    flat_array(const T *data, std::size_t n) : items(data), n(n) {}
+
+    /// \brief copies owned elements, or the view of the others
+    flat_array(const flat_array &other)
+        : owned(other.owned),
+          items(other.items == other.owned.data() ? owned.data()
+                                                  : other.items),
+          n(other.n) {}
+
+    flat_array(flat_array &&other) noexcept = default; ///< keeps the elements
+
+    flat_array &operator=(flat_array other) noexcept {
+        std::swap(owned, other.owned);
+        std::swap(items, other.items);
+        std::swap(n, other.n);
+        return *this;
+    }
+
+    const T &operator[](std::size_t i) const noexcept { return items[i]; }
+    const T *data() const noexcept { return items; }
+    const T *begin() const noexcept { return items; }
+    const T *end() const noexcept { return items + n; }
+    std::size_t size() const noexcept { return n; }
+};
+
+/// \brief immutable compressed sparse row snapshot of a Graph
+///
+/// vertices are renumbered into dense indices 0..V-1 (in increasing order of
+/// their ids) and all out edges are packed into flat contiguous arrays: the
+/// edges of vertex u are the range [first(u), last(u)) of targets and weights.
+/// this keeps the relaxation loop of a query walking plain arrays instead of
+/// chasing tree nodes and heap pointers. the same arrays make up the binary
+/// format of save(), so that load() maps a file and queries it in place
+class CsrGraph {
+    flat_array<int> _offsets;           ///< V + 1 offsets into the edge arrays
+    flat_array<int> _targets;           ///< dense index of each edge's sink
+    flat_array<edge_weight_t> _weights; ///< weight of each edge
+    flat_array<vertex_id> _ids;         ///< dense index to vertex id, sorted
+    flat_array<vertex_value_t> _values; ///< dense index to vertex value
+    edge_weight_t _min_weight = 0;      ///< lightest edge, 0 if no edges
+    edge_weight_t _max_weight = 0;      ///< heaviest edge, 0 if no edges
+    std::shared_ptr<const void> _file;  ///< mapping the arrays may point to
+
+  public:
+    CsrGraph() = default; ///< default snapshot is empty
+
+    /// \brief packs the vertices and edges of graph into flat arrays
+    ///
+    /// \param graph graph to take the snapshot of
+    explicit CsrGraph(const Graph &graph);
+
+    /// \return number of vertices
+    int order() const noexcept { return _ids.size(); }
+
+    /// \return number of edges
+    int size() const noexcept { return _targets.size(); }
+
+    /// \return true if vertex u is in the snapshot
+    bool has_vertex(vertex_id u) const;
+
+    /// \brief translates a vertex id to its dense index, throws if not found
+    ///
+    /// \param u vertex id
+    ///
+    /// \return dense index of u in 0..V-1
+    int index(vertex_id u) const;
+
+    /// \return vertex id of the dense index i
+    vertex_id identity(int i) const noexcept { return _ids[i]; }
+
+    /// \return vertex value of the dense index i
+    const vertex_value_t &value(int i) const noexcept { return _values[i]; }
+
+    /// \return index of the first edge of the dense index u
+    int first(int u) const noexcept { return _offsets[u]; }
+
+    /// \return index past the last edge of the dense index u
+    int last(int u) const noexcept { return _offsets[u + 1]; }
+
+    /// \return dense index of the sink of edge e
+    int target(int e) const noexcept { return _targets[e]; }
+
+    /// \return weight of the edge e
+    const edge_weight_t &weight(int e) const noexcept { return _weights[e]; }
+
+    /// \brief transposes the snapshot, every edge u -> v becomes v -> u with
+    /// the same weight while dense indices are kept
+    ///
+    /// \return the reversed snapshot
+    CsrGraph reverse() const;
+
+    /// \return weight of the lightest edge, 0 if there are no edges
+    edge_weight_t min_weight() const noexcept { return _min_weight; }
+
+    /// \return weight of the heaviest edge, 0 if there are no edges
+    edge_weight_t max_weight() const noexcept { return _max_weight; }
+
+    /// \brief writes the snapshot in a versioned binary format: a header
+    /// followed by the offsets, targets, weights, values and ids arrays, as
+    /// they are laid out in memory
+    ///
+    /// \param out stream to write to, should be opened in binary mode
+    void save(std::ostream &out) const;
+
+    /// \brief maps a file written by save() in memory, the arrays are used in
+    /// place so loading neither parses nor allocates per edge. pages are only
+    /// read once queries touch them. throws if the file is not a snapshot, of
+    /// another version, truncated or corrupt. checking the arrays reads them
+    /// all once, files known to be written by save() may skip it
+    ///
+    /// \param fd file descriptor of the file, can be closed afterward
+    /// \param trusted if true, the arrays are not checked
+    /// \return the snapshot, sharing the mapping with its copies
+    static CsrGraph load(int fd, bool trusted = false);
+
+    /// \brief same as load(fd), opening the file first
+    static CsrGraph load(const std::string &filename, bool trusted = false);
+
+    /// \brief unit testing of the snapshot against the graph it was built of
+    static void unit_testing() noexcept;
+
+  private:
+    /// \return true if the offsets do not decrease, the targets are vertices,
+    /// the ids are sorted and the weights in the range of the header
+    bool consistent() const;
+};
+
+#endif /* CSR_GRAPH_H */
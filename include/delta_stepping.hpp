@@ -0,0 +1,63 @@
+#ifndef DELTA_STEPPING_H
+#define DELTA_STEPPING_H
+
+#include "short_path.hpp"
+#include "thread_pool.hpp"
+
+#include <atomic>
+
+/// \brief parallel single source shortest paths using delta-stepping
+///
+/// vertices are kept in buckets of width delta by their tentative distance.
+/// buckets are processed in order, all vertices of the current bucket at once:
+/// their light edges (weight up to delta) are relaxed in parallel, possibly
+/// refilling the bucket, until it stays empty, then the heavy edges of every
+/// vertex it held are relaxed once. a small delta does the work of Dijkstra's
+/// algorithm with little parallelism, a large one exposes more parallelism at
+/// the cost of relaxing edges again
+class DeltaStepping {
+    const CsrGraph &g; ///< snapshot in which we operate
+    int delta;         ///< width of the buckets
+    ThreadPool pool;   ///< threads relaxing the edges
+
+    /// \brief relaxes the edges of the vertices from the frontier whose weight
+    /// is in [lo, hi], in parallel, and files improved vertices in buckets
+    void relax(const std::vector<int> &frontier, int lo, int hi,
+               std::vector<std::atomic<int>> &dist,
+               std::vector<std::vector<int>> &buckets);
+
+  public:
+    /// \brief distance of the vertices that are not reachable
+    static constexpr int unreachable = -1;
+
+    /// \brief constructor setting up the threads
+    ///
+    /// \param csr snapshot in which we would operate, should outlive this
+    /// \param delta width of the buckets, by default the heaviest weight over
+    /// the average degree
+    /// \param n_threads number of threads sharing the relaxations
+    explicit DeltaStepping(
+        const CsrGraph &csr, int delta = 0,
+        unsigned n_threads = std::thread::hardware_concurrency());
+
+    int width() const noexcept { return delta; } ///< width of the buckets
+
+    /// \brief computes the distances from the source to every vertex, throws
+    /// if the source is not found in the snapshot
+    ///
+    /// \param source vertex to go from
+    /// \return distances by dense index, unreachable if there is no path
+    std::vector<int> distances(vertex_id source);
+
+    /// \brief same as distances(), except predecessors are traced too along
+    /// the edges that are tight with the distances
+    ///
+    /// \param source vertex to go from
+    /// \return the distances and predecessors of all vertices
+    path_tree shortest_path_tree(vertex_id source);
+
+    /// \brief testing all class functions
+    static void unit_testing() noexcept;
+};
+
+#endif /* DELTA_STEPPING_H */
@@ -3,69 +3,53 @@
 
 #include <algorithm>
 #include <chrono>
+#include <cmath>
 #include <functional>
 #include <iostream>
 #include <map>
 #include <memory>
+#include <optional>
 #include <random>
+#include <set>
 #include <sstream>
 #include <stdexcept>
+#include <string_view>
 #include <thread>
 #include <utility>
 #include <vector>
 
 #define itr_range(cont) std::begin(cont), std::end(cont) /// handy macro
 
-class Vertex;
-class Edge;
+class CsrGraph;
 
 using vertex_id = int;
 using vertex_value_t = int;
 using edge_weight_t = int;
 
-using vertex_ptr = std::shared_ptr<Vertex>;
-using vertex_pref = const vertex_ptr &;
-using vertex_wptr = std::weak_ptr<Vertex>;
-
-using edge_ptr = std::unique_ptr<Edge>;
-using edge_pref = const edge_ptr &;
-
-/// \brief representation of an edge, tracking from/to vertices and the weight
-/// between them
+/// \brief representation of an out edge, tracking the vertex it goes to and
+/// the weight between them
 ///
-/// since the this class depends on the Vertex class, we must use pointers, but
-/// smart pointers are better. this class keeps track of vertices using weak
-/// pointers to avoid memory overhead
+/// edges are stored by value in the adjacency list of the vertex they go from,
+/// which makes it implicit. the vertex they go to is referred to by its id and
+/// its dense index in the graph rather than by pointers, so there is neither
+/// an allocation nor a reference count per edge. the vertex they go to keeps
+/// a reversed copy, going to the vertex it comes from
 class Edge {
-    vertex_wptr _source; ///< vertex we're going from
-    vertex_wptr _sink;   ///< vertex we're going to
-    edge_weight_t _wei;  ///< the weight between the two vertices
+    vertex_id _sink;    ///< vertex we're going to
+    int _index;         ///< dense index of the vertex we're going to
+    edge_weight_t _wei; ///< the weight between the two vertices
 
   public:
-    Edge() = delete;             ///< cannot be constructed by default
-    Edge(const Edge &) = delete; ///< cannot be constructed by copy
-    Edge(Edge &&other) = delete; ///< nor can it be constructed by a move
-
-    /// \brief creating an edge between two vertices, both should exist
-    /// beforehand. throws if either is nullptr
+    /// \brief creating an edge to a vertex
     ///
-    /// \param from pointer to the vertex we're coming from
-    /// \param to pointer to the vertex we're going to
+    /// \param to id of the vertex we're going to
+    /// \param index dense index of the vertex we're going to
     /// \param wei the weight og the ride
-    Edge(vertex_pref from, vertex_pref to, const edge_weight_t &wei);
-
-    Edge &operator=(const Edge &other) = delete; ///< cannot be copied
-    Edge &operator=(Edge &&other) = delete;      ///< cannot be moved
-
-    /// \brief the vertex this edge pointing from
-    ///
-    /// \return a shared pointer from the locked weak pointer
-    vertex_ptr from() const;
+    Edge(vertex_id to, int index, const edge_weight_t &wei);
 
-    /// \brief the vertex this edge pointing to
-    ///
-    /// \return a shared pointer from the locked weak pointer
-    vertex_ptr to() const;
+    vertex_id to() const; ///< the vertex this edge pointing to
+    int index() const;    ///< dense index of the vertex this edge pointing to
+    void index(int i);    ///< mutator of the index, once the vertex moved
 
     const edge_weight_t &weight() const;   ///< accessor to the weight
     void weight(const edge_weight_t &wei); ///< mutator of the weight
@@ -74,20 +58,19 @@ class Edge {
 /// \brief Vertex represenation using adjacensy list. Each vertex keeps track of
 /// which out edges it has as well as its id and value
 ///
-/// the inhiritance from enable_shared_from_this is to avoid provide a shared
-/// pointer to the current insatnce double free errors.
-///
-/// check this SO question: https://stackoverflow.com/q/712279/5744492
-class Vertex : public std::enable_shared_from_this<Vertex> {
-    std::map<vertex_id, edge_ptr> _edges; ///< adjancency list
+/// out edges are kept sorted by the id of the vertex they go to in a flat
+/// vector, as are the reversed edges to this one, so searches going backward
+/// read weights as directly as the ones going forward. the Graph owning the
+/// vertices links both ends of every edge
+class Vertex {
+    std::vector<Edge> _edges; ///< adjancency list, sorted by sink
+    std::vector<Edge> _in;    ///< edges to this one reversed, sorted by source
 
     vertex_id _id;
     vertex_value_t _val;
 
   public:
-    Vertex() = delete;               ///< verticex are not default constructed
-    Vertex(const Vertex &) = delete; ///< nor copy constructable
-    Vertex(Vertex &&other) = delete; ///< nor constructable via a move
+    Vertex() = delete; ///< verticex are not default constructed
 
     /// \brief a vertex has an id an a value, it has no edges by default
     ///
@@ -95,9 +78,6 @@ class Vertex : public std::enable_shared_from_this<Vertex> {
     /// \param val vertex value
     Vertex(vertex_id id, const vertex_value_t &val);
 
-    Vertex &operator=(const Vertex &other) = delete; ///< cannot be copied
-    Vertex &operator=(Vertex &&other) = delete;      ///< not ca they be moved
-
     /// \brief get all the edges of the vertex as pair of ids, the first element
     /// if the vertex's id
     ///
@@ -109,61 +89,117 @@ class Vertex : public std::enable_shared_from_this<Vertex> {
     /// \return vector of all the ids of the neighbors of this vertex
     std::vector<vertex_id> neighbors() const;
 
+    /// \brief obtain the ids of all vertices having an edge to this vertex
+    ///
+    /// \return vector of all the ids of the predecessors of this vertex
+    std::vector<vertex_id> predecessors() const;
+
+    /// \return out edges sorted by the vertex they go to
+    const std::vector<Edge> &out() const { return _edges; }
+
+    /// \return edges to this vertex reversed, going to the predecessors
+    /// which they are sorted by
+    const std::vector<Edge> &in() const { return _in; }
+
     vertex_id identity() const;            ///< accessor to the identity
     const vertex_value_t &value() const;   ///< accessor to value
     void value(const vertex_value_t &val); ///< mutator of the value
 
     /// \return true if vertex v is adjacent to this vertex
-    bool adjacent(vertex_pref v) const;
+    bool adjacent(vertex_id v) const;
 
-    /// \return edge to vertrex v
-    const edge_ptr &edge(vertex_pref v) const;
+    /// \return edge to vertex v, nullptr if there is none
+    const Edge *edge(vertex_id v) const;
 
-    /// \brief add a directed edge from vertex v to vertex u
-    ///
-    /// \param v pointer to vertex as sink to the edge
-    /// \param wei weight of the edge
-    void add_directed_edge(vertex_pref v, const edge_weight_t &wei);
+    /// \brief non const version of edge()
+    Edge *edge(vertex_id v);
 
-    /// \brief add an undirected edge from vertex v to vertex u. basically as
-    /// adding two directed edges between this vertex and v
-    ///
-    /// which means adding another edge to the adjacency list of vertex v.
-    /// both edges have the same weight
-    ///
-    /// \param v pointer to vertex as sink of the edge
-    /// \param wei weight of the edge
-    void add_edge(vertex_pref v, const edge_weight_t &wei);
+    /// \return reversed edge from vertex u, nullptr if there is none
+    Edge *edge_from(vertex_id u);
 
-    /// \brief overload od add_edge() where we can specify the weight to
-    /// residual edge
-    ///
-    /// edge from this vertex to v has weight wei, where edge from vertex v to
-    /// this vertex has weight re_wei
-    ///
-    /// \param v pointer to vertex as sink of the edge
-    /// \param wei weight of the edge
-    /// \param wei weight of the residual edge
-    void add_edge(vertex_pref v, const edge_weight_t &wei,
-                  const edge_weight_t &re_wei);
+    /// \brief reserve room for edges from and to this vertex
+    void reserve(int n_out, int n_in);
 
-    /// \brief remove edge to vertex v
+    /// \brief inserts an out edge in order, unless one goes to the same vertex
     ///
-    /// \param v pointer to the vertex we want to remove edge to
-    void remove_directed_edge(vertex_pref v);
+    /// \return true if the edge is inserted
+    bool add_out(const Edge &e);
 
-    /// \brief removes both the edge and its residual, meaning it removes the
-    /// edge from this vertex and from vertex v
+    /// \brief same as add_out() in constant time and without checking for an
+    /// existing edge, e should go to a vertex greater than all neighbors
+    void append_out(const Edge &e);
+
+    /// \brief records that vertex u of the given index has an edge to this one
+    void add_in(vertex_id u, int index, const edge_weight_t &wei);
+
+    /// \brief same as add_in() in constant time, u should be greater than all
+    /// predecessors
+    void append_in(vertex_id u, int index, const edge_weight_t &wei);
+
+    /// \brief removes the edge to vertex v, if any
     ///
-    /// \param v pointer to the vertex we want to remove edges to and from
-    void remove_edge(vertex_pref v);
+    /// \return true if an edge is removed
+    bool remove_out(vertex_id v);
+
+    /// \brief forgets that vertex u has an edge to this one
+    void remove_in(vertex_id u);
+
+    /// \brief updates the index of vertex u in the edges to and from it
+    void relocate(vertex_id u, int index);
+};
+
+/// \brief view over the out edges of a vertex, yielding pairs of neighbor id
+/// and weight straight from its adjacency list rather than copying it. any
+/// change to the edges of the vertex invalidates the view
+class neighbor_view {
+    const Edge *first = nullptr, *last = nullptr;
+
+  public:
+    /// \brief turns each edge into a pair of neighbor and weight, yielded by
+    /// value so it is only an input iterator
+    class iterator {
+        const Edge *e;
+
+      public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = std::pair<vertex_id, edge_weight_t>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = value_type;
+
+        explicit iterator(const Edge *e) : e(e) {}
+        value_type operator*() const { return {e->to(), e->weight()}; }
+        iterator &operator++() { return ++e, *this; }
+        iterator operator++(int) { return iterator{e++}; }
+        bool operator==(const iterator &other) const { return e == other.e; }
+        bool operator!=(const iterator &other) const { return e != other.e; }
+    };
+
+    neighbor_view() = default; ///< default view is empty
+
+    /// \brief views the edges, which should outlive this
+    explicit neighbor_view(const std::vector<Edge> &edges)
+        : first(edges.data()), last(edges.data() + edges.size()) {}
+
+    iterator begin() const noexcept { return iterator{first}; }
+    iterator end() const noexcept { return iterator{last}; }
+    int size() const noexcept { return last - first; }
+    bool empty() const noexcept { return first == last; }
 };
 
 /// \brief Graph representation as a set of vertices where each vertex holds its
 /// edges. it provides handy way to manipulate the vertices and their edges
 /// using ids only without the overhead of pointers
+///
+/// vertices live in a flat vector, so each has a dense index in 0..V-1 and a
+/// map translates vertex ids to them. removing a vertex moves the last one in
+/// its place, so algorithms can keep their state in plain vectors indexed by
+/// order() and only translate back to vertex ids at the end
 class Graph {
-    std::map<vertex_id, vertex_ptr> _vertices; ///< all vertices in the graph
+    std::vector<Vertex> _vertices;     ///< vertices by dense index
+    std::map<vertex_id, int> _indices; ///< vertex id to its dense index
+
+    friend class GraphBuilder; ///< fills both at once
 
   public:
     Graph() = default;             ///< default graph is empty
@@ -171,14 +207,37 @@ class Graph {
 
     Graph(Graph &&other) noexcept; ///< but can be moved
 
-    /// \brief generates a graph with n_vertices and has edges picked based on
-    /// their density compared to the total number of edges in a complete graph
+    /// \brief generates a graph with n_vertices where each of the possible
+    /// undirected edges is picked with probability edge_density (G(n, p)),
+    /// weights are in [1, 500]
     ///
     /// \param n_vertices number of vertices in the graph
     /// \param edge_density a value decimal between 0.0 and 1.0
     Graph(int n_vertices, double edge_density);
 
-    /// \brief constructs a graph based on the provides vertices and edges
+    /// \brief same as Graph(n_vertices, edge_density), except the random
+    /// generator is seeded by the caller so the graph can be reproduced
+    ///
+    /// \param n_vertices number of vertices in the graph
+    /// \param edge_density a value decimal between 0.0 and 1.0
+    /// \param seed seed of the random generator
+    Graph(int n_vertices, double edge_density, unsigned seed);
+
+    /// \brief same as Graph(n_vertices, edge_density, seed), with weights
+    /// drawn uniformly from the distance range. rather than flipping a coin
+    /// for every candidate edge, the gaps between picked edges are drawn, so
+    /// generating takes time proportional to the vertices and edges produced
+    ///
+    /// \param n_vertices number of vertices in the graph
+    /// \param edge_density a value decimal between 0.0 and 1.0
+    /// \param distance_range minimum and maximum weight of the edges
+    /// \param seed seed of the random generator
+    Graph(int n_vertices, double edge_density,
+          std::pair<edge_weight_t, edge_weight_t> distance_range,
+          unsigned seed);
+
+    /// \brief constructs a graph based on the provides vertices and edges,
+    /// all at once with a GraphBuilder
     ///
     /// \param vertices vector of vertex ids and their values
     /// \param edges vector of pair of vertex ids and their weights
@@ -217,6 +276,9 @@ class Graph {
     /// \return value to the vertex
     const vertex_value_t &value(vertex_id u) const;
 
+    /// \brief same as value(u), except it returns nothing if u is not found
+    std::optional<vertex_value_t> try_value(vertex_id u) const noexcept;
+
     /// \brief mutator of vertex value, throws if vertex is not found
     ///
     /// \param u vertex to alter
@@ -237,12 +299,33 @@ class Graph {
     /// \return vector of ids of all the neighbors
     std::vector<vertex_id> neighbors(vertex_id u) const;
 
+    /// \brief same as neighbors(), except it copies nothing and goes with the
+    /// weights, for loops such as `for (auto [v, wei] : weighted_neighbors(u))`
+    ///
+    /// \param u vertex to get its neighbors, throws if not found
+    ///
+    /// \return view of pairs of neighbor id and weight, sorted by id
+    neighbor_view weighted_neighbors(vertex_id u) const;
+
+    /// \brief get all predecessors of a certain vertex, that is the neighbors
+    /// of the vertex if all edges were reversed
+    ///
+    /// \param u vertex to get its predecessors
+    ///
+    /// \return vector of ids of all vertices having an edge to u
+    std::vector<vertex_id> predecessors(vertex_id u) const;
+
     /// \brief add a vertex to the graph
     ///
     /// \param u vertex to add
     /// \param val value of the vertex
     void add_vertex(vertex_id u, const vertex_value_t &val);
 
+    /// \brief same as add_vertex(), except it does nothing if u exists
+    ///
+    /// \return true if the vertex is added
+    bool try_add_vertex(vertex_id u, const vertex_value_t &val);
+
     /// \brief removes a vertex from the graph, all its edges are removed too
     ///
     /// \param u vertex to remove
@@ -256,12 +339,24 @@ class Graph {
     /// \return edge weight
     const edge_weight_t &weight(std::pair<vertex_id, vertex_id> e) const;
 
+    /// \brief same as weight(e), except it returns nothing if either vertex
+    /// or the edge is not found
+    std::optional<edge_weight_t>
+    try_weight(std::pair<vertex_id, vertex_id> e) const noexcept;
+
     /// \brief mutator of the weight of a certain edge
     ///
     /// \param e edge as pair of vertex ids
     /// \param wei new weight of the edge
     void weight(std::pair<vertex_id, vertex_id> e, const edge_weight_t &wei);
 
+    /// \brief same as weight(e, wei), except it does nothing if either vertex
+    /// or the edge is not found
+    ///
+    /// \return true if the weight is changed
+    bool try_weight(std::pair<vertex_id, vertex_id> e,
+                    const edge_weight_t &wei);
+
     /// \brief add a directed edge between to vertices, throws of either vertex
     /// is not found
     ///
@@ -270,6 +365,13 @@ class Graph {
     void add_directed_edge(std::pair<vertex_id, vertex_id> e,
                            const edge_weight_t &wei);
 
+    /// \brief same as add_directed_edge(), except it does nothing if either
+    /// vertex is not found
+    ///
+    /// \return true if the edge is added, false if it is not or existed
+    bool try_add_directed_edge(std::pair<vertex_id, vertex_id> e,
+                               const edge_weight_t &wei);
+
     /// \brief same as add_directed_edge(), except if either vertex is not
     /// found, it's added to the graph with value 0
     void create_directed_edge(std::pair<vertex_id, vertex_id> e,
@@ -307,28 +409,104 @@ class Graph {
     /// \param e a pair of vertex ids
     void remove_directed_edge(std::pair<vertex_id, vertex_id> e);
 
+    /// \brief same as remove_directed_edge(), except it does nothing if the
+    /// edge or either vertex is not found
+    ///
+    /// \return true if the edge is removed
+    bool try_remove_directed_edge(std::pair<vertex_id, vertex_id> e);
+
     /// \brief same as remove_directed_edge(), except it removes both edges as
     /// if there was an undirected edge
     void remove_edge(std::pair<vertex_id, vertex_id> e);
 
+    /// \return number of vertices, which have dense indices in 0..order()-1
+    int order() const noexcept { return _vertices.size(); }
+
+    /// \brief translates a vertex id to its dense index, throws if not found.
+    /// indices are invalidated by remove_vertex()
+    ///
+    /// \param u vertex id
+    ///
+    /// \return dense index of u
+    int index(vertex_id u) const;
+
+    /// \brief same as index(), except it returns nothing if u is not found
+    std::optional<int> try_index(vertex_id u) const noexcept;
+
+    /// \return vertex id of the dense index i
+    vertex_id identity(int i) const noexcept { return _vertices[i].identity(); }
+
+    /// \return vertex of the dense index i, Edge::index() of its edges and the
+    /// indices of its predecessors are dense indices too
+    const Vertex &at(int i) const noexcept { return _vertices[i]; }
+
+    /// \brief takes an immutable snapshot of the graph packed into flat arrays,
+    /// later changes to the graph are not reflected on the snapshot
+    ///
+    /// \return compressed sparse row snapshot of the graph
+    CsrGraph freeze() const;
+
+    /// \brief parses a graph in the algs4 format, that is the number of
+    /// vertices V, the number of edges E, then E lines of "u v" or "u v w".
+    /// vertices are 0 to V - 1 with value 0, weights default to 1 and are
+    /// multiplied by scale then rounded, so decimal weights survive. parallel
+    /// edges keep the first weight. throws if the text is malformed
+    ///
+    /// \param text whole content of the file
+    /// \param directed if false, every line is an undirected edge
+    /// \param scale factor applied to the weights
+    /// \return the parsed graph
+    static Graph parse_algs4(std::string_view text, bool directed = true,
+                             int scale = 1);
+
+    /// \brief same as parse_algs4(), reading the whole file descriptor. regular
+    /// files are mapped in memory, anything else (pipes) is read in large
+    /// chunks. throws if reading fails
+    static Graph load_algs4(int fd, bool directed = true, int scale = 1);
+
+    /// \brief same as load_algs4(fd), opening the file first
+    static Graph load_algs4(const std::string &filename, bool directed = true,
+                            int scale = 1);
+
     /// \brief unit testing  of all classes functionalities
     static void unit_testing() noexcept;
 
   private:
+    /// \brief adds the edge between the vertices of both indices, if missing
+    ///
+    /// \return true if the edge is added
+    bool link(int from, int to, const edge_weight_t &wei);
+
+    /// \brief same as link() in constant time, for building graphs in order.
+    /// to should be greater than all the neighbors of from, and from greater
+    /// than all the predecessors of to
+    void append_link(int from, int to, const edge_weight_t &wei);
+
+    /// \brief removes the edge between the vertices of both indices, if any
+    ///
+    /// \return true if an edge is removed
+    bool unlink(int from, int to);
+
+    /// \brief throws the concatenation of msg, kept apart so the checks
+    /// passing never build strings
     template <typename... Args>
-    void vertex_check(bool in, vertex_id id, const Args &... msg) const {
+    [[noreturn]] static void fail(const Args &... msg) {
         using List = int[];
         std::ostringstream stream;
         (void)List{0, ((void)(stream << msg), 0)...};
+        throw std::runtime_error(stream.str());
+    }
 
-        auto itr = _vertices.find(id);
-        if (in) {
-            if (itr == std::end(_vertices))
-                throw std::runtime_error(stream.str());
-        } else {
-            if (itr != std::end(_vertices))
-                throw std::runtime_error(stream.str());
-        }
+    /// \brief checks that vertex id is in the graph, or not, throwing msg
+    /// otherwise
+    ///
+    /// \return dense index of the vertex if it should be in, -1 otherwise
+    template <typename... Args>
+    int vertex_check(bool in, vertex_id id, const Args &... msg) const {
+        auto itr = _indices.find(id);
+        if (in != (itr != std::end(_indices)))
+            fail(msg...);
+        return in ? itr->second : -1;
     }
 };
 #endif /* GRAPH_H */
@@ -0,0 +1,75 @@
+#ifndef GRAPH_BUILDER_H
+#define GRAPH_BUILDER_H
+
+#include "graph.hpp"
+
+/// \brief builds a Graph from batches of vertices and edges all at once
+///
+/// adding edges one by one costs a search in the adjacency of both ends.
+/// instead the builder collects the batches, radix sorts the edges by source
+/// then sink with two stable counting sorts over the ranks of the vertex ids,
+/// drops the parallel edges and appends the whole adjacency in one pass, each
+/// list sized beforehand. large batches are sorted by several threads, each
+/// counting its own slice. the graph built is the same as adding the vertices
+/// then the edges in order: parallel edges keep the first weight, throws if a
+/// vertex is added twice or an edge has an end which is not added
+class GraphBuilder {
+  public:
+    /// \brief edge as taken by the Graph constructor, ((from, to), weight)
+    using edge = std::pair<std::pair<vertex_id, vertex_id>, edge_weight_t>;
+
+    /// \brief number of edges from which the sorts are split across threads
+    static constexpr std::size_t parallel_threshold = 1 << 20;
+
+  private:
+    /// \brief edge as stored, between ids until build() turns them to ranks
+    struct entry {
+        int from, to;
+        edge_weight_t wei;
+    };
+
+    std::vector<std::pair<vertex_id, vertex_value_t>> vertices; ///< in order
+    std::vector<entry> entries; ///< edges in order, both ways if undirected
+    bool directed;              ///< if false, edges are added both ways
+    unsigned n_threads;         ///< threads sorting large batches
+
+  public:
+    /// \param directed if false, every edge is added both ways
+    /// \param n_threads number of threads sorting large batches
+    explicit GraphBuilder(
+        bool directed = true,
+        unsigned n_threads = std::thread::hardware_concurrency());
+
+    /// \brief reserves room for the vertices and edges to come
+    void reserve(std::size_t n_vertices, std::size_t n_edges);
+
+    /// \brief queues vertex u with its value
+    void add_vertex(vertex_id u, const vertex_value_t &val);
+
+    /// \brief queues a batch of vertices with their values
+    void add_vertices(
+        const std::vector<std::pair<vertex_id, vertex_value_t>> &batch);
+
+    /// \brief queues the edge e, its ends may be added later
+    void add_edge(std::pair<vertex_id, vertex_id> e, const edge_weight_t &wei);
+
+    /// \brief queues a batch of edges, batches may keep coming until build()
+    void add_edges(const std::vector<edge> &batch);
+
+    /// \return number of edges queued, counted twice if undirected
+    std::size_t size() const noexcept { return entries.size(); }
+
+    /// \brief builds the graph of everything queued, leaving the builder empty
+    ///
+    /// vertices get dense indices in the order they are added. throws
+    /// "vertex u already exists" or "vertex u is not found" as adding them one
+    /// by one would, for the first faulty vertex or edge
+    ///
+    /// \return the graph built
+    Graph build();
+
+    /// \brief testing all class functions
+    static void unit_testing() noexcept;
+};
+
+#endif /* GRAPH_BUILDER_H */
@@ -0,0 +1,69 @@
+#ifndef MONTE_CARLO_H
+#define MONTE_CARLO_H
+
+#include "short_path.hpp"
+#include "thread_pool.hpp"
+
+#include <cstdint>
+
+/// \brief Monte Carlo simulation of the average shortest path of random graphs
+///
+/// each trial generates a random graph and averages the costs of the paths from
+/// its first vertex to every other reachable vertex. trials run independently
+/// across a thread pool, each drawing from its own random stream derived from
+/// one master seed and its index, and the statistics are aggregated in trial
+/// order, so results are bit-identical for a seed whatever the thread count
+class MonteCarlo {
+  public:
+    /// \brief parameters of a simulation
+    struct config {
+        int n_vertices = 50;      ///< vertices of every random graph
+        double edge_density = .2; ///< edge density of every random graph
+        std::pair<edge_weight_t, edge_weight_t> distance_range{1, 500};
+        int n_trials = 100;       ///< number of graphs to generate
+        std::uint64_t seed = 0;   ///< master seed of all the random streams
+        unsigned n_threads = std::thread::hardware_concurrency();
+    };
+
+    /// \brief outcome of a single trial
+    struct trial {
+        int n_edges = 0;     ///< edges of the generated graph
+        int n_paths = 0;     ///< number of reachable vertices from the first
+        long total_cost = 0; ///< sum of the costs of those paths
+    };
+
+    /// \brief statistics aggregated over all trials
+    struct summary {
+        int n_trials = 0;      ///< trials having at least one path
+        double mean = 0;       ///< mean of the average path of each trial
+        double stddev = 0;     ///< standard deviation of those averages
+        double min = 0;        ///< smallest average path of a trial
+        double max = 0;        ///< largest average path of a trial
+        double mean_edges = 0; ///< mean number of edges of the graphs
+    };
+
+    /// \brief derives the seed of a trial from the master seed, using the
+    /// splitmix64 finalizer so that nearby indices get unrelated streams
+    ///
+    /// \param seed master seed
+    /// \param index index of the trial
+    /// \return seed of the trial's random generator
+    static unsigned stream_seed(std::uint64_t seed, std::uint64_t index);
+
+    /// \brief runs a single trial
+    ///
+    /// \param conf parameters of the simulation
+    /// \param index index of the trial
+    static trial run_trial(const config &conf, int index);
+
+    /// \brief runs all trials of the simulation and aggregates them
+    ///
+    /// \param conf parameters of the simulation
+    static summary run(const config &conf);
+
+    /// \brief runs the simulation of the assignment, 50 vertices with 20% and
+    /// 40% edge densities, on one and on all threads
+    static void unit_testing() noexcept;
+};
+
+#endif /* MONTE_CARLO_H */
@@ -0,0 +1,47 @@
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <array>
+
+/// \brief group of hardware performance counters of the calling thread
+///
+/// on Linux, the counters are opened with perf_event_open() as one group so
+/// they are scheduled together and their ratios are consistent. only user
+/// space is counted. if the kernel refuses (no PMU in a virtual machine,
+/// perf_event_paranoid too strict) or on other systems, the counters are
+/// unavailable and read as zeros, so callers need not care. counters that
+/// were multiplexed with other events are scaled to the time they were
+/// enabled
+class PerfCounters {
+  public:
+    /// \brief counted events, in the order of the group
+    enum event { cycles, instructions, llc_misses, branch_misses, n_events };
+
+    /// \brief cumulative count of each event
+    using sample = std::array<long long, n_events>;
+
+    /// \brief names of the events, as used in csv headers
+    static const std::array<const char *, n_events> names;
+
+  private:
+    std::array<int, n_events> fds; ///< file descriptor of each event, or -1
+
+  public:
+    /// \brief opens and starts the counters, never throws if they cannot be
+    PerfCounters();
+    PerfCounters(const PerfCounters &) = delete;
+    PerfCounters &operator=(const PerfCounters &) = delete;
+    ~PerfCounters();
+
+    /// \return true if the event is counted
+    bool has(event e) const noexcept { return fds[e] != -1; }
+
+    /// \return true if any event is counted
+    bool available() const noexcept { return has(cycles); }
+
+    /// \return counts since the counters were opened, zeros for the events
+    /// that are not counted
+    sample read() const;
+};
+
+#endif /* PERF_COUNTERS_H */
@@ -3,39 +3,101 @@
 
 #include <functional>
 #include <iostream>
-#include <map>
-#include <set>
 #include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
 
-/// \brief Priority Queue Data structure
+/// \brief Indexed d-ary heap Priority Queue Data structure
 ///
-/// It orders items based on their priority, which could be changed.
-class PQ {
+/// It orders items based on their priority, which could be changed. items live
+/// in a flat array laid out as a complete tree where each node has Arity
+/// children, and a position array maps each value to its slot in the heap, so
+/// contains() is O(1) while push(), pop() and change_priority() are O(lg n).
+/// values are used as indices into the position array, hence they should be
+/// non-negative and preferably dense
+///
+/// \tparam Arity number of children per node, wider nodes make the heap
+/// shallower at the cost of more comparisons per level
+template <unsigned Arity = 4> class DaryPQ {
+    static_assert(Arity >= 2, "a heap node needs at least two children");
+
   public:
     /// \brief each item in the priority queue is a pair of value and priority
     using item = std::pair</* value */ int, /* priority */ int>;
 
-    /// \brief functor for comparing two items by their priority
+    /// \brief functor for comparing two items by their priority. ties are
+    /// broken by value so that items sharing a priority never collapse
     struct cmp {
         bool operator()(const item &u, const item &v) const {
-            return u.second < v.second;
+            return u.second < v.second or
+                   (u.second == v.second and u.first < v.first);
         }
     };
 
   private:
-    /// \brief keeping items inside a map to guarantee O(lg n) for all
-    /// operations
-    ///
-    /// values should be unique since push() throws if an item is not inserted
-    std::map<int, item> items;
+    static constexpr int npos = -1; ///< position of values not in the queue
+
+    std::vector<item> heap; ///< items ordered as a d-ary heap
+    std::vector<int> pos;   ///< value to index in heap, npos if absent
+
+    /// \brief puts item at index i in heap and keeps track of its position
+    void place(int i, const item &it) {
+        heap[i] = it;
+        pos[it.first] = i;
+    }
 
-    /// \brief keeping the items inside a set to make sure their ordered since
-    /// STL sets are ordered using cmp (item's priority). The reference wrapper
-    /// is to avoid having duplicates, all items are stored in the items map
-    std::set<std::reference_wrapper<item>, cmp> pq;
+    /// \brief moves the item at index i up while it has a better priority than
+    /// its parent
+    void sift_up(int i) {
+        const item it = heap[i];
+        while (i > 0) {
+            const int parent = (i - 1) / Arity;
+            if (not cmp{}(it, heap[parent]))
+                break;
+            place(i, heap[parent]);
+            i = parent;
+        }
+        place(i, it);
+    }
+
+    /// \brief moves the item at index i down while one of its children has a
+    /// better priority
+    void sift_down(int i) {
+        const item it = heap[i];
+        const int n = heap.size();
+        while (true) {
+            const int first = i * Arity + 1;
+            if (first >= n)
+                break;
+            const int last = std::min<int>(first + Arity, n);
+            int best = first;
+            for (int child = first + 1; child < last; ++child)
+                if (cmp{}(heap[child], heap[best]))
+                    best = child;
+            if (not cmp{}(heap[best], it))
+                break;
+            place(i, heap[best]);
+            i = best;
+        }
+        place(i, it);
+    }
 
   public:
-    PQ() = default; ///< default constructor
+    DaryPQ() = default; ///< default constructor
+
+    /// \brief constructor reserving room for values in the range [0, capacity)
+    /// so that the position array never grows while pushing them
+    ///
+    /// \param capacity expected upper bound of values
+    explicit DaryPQ(int capacity) { reserve(capacity); }
+
+    /// \brief reserve room for values in the range [0, capacity)
+    void reserve(int capacity) {
+        if (capacity > static_cast<int>(pos.size()))
+            pos.resize(capacity, npos);
+        heap.reserve(capacity);
+    }
 
     /// \brief pushing an new unique item to the priority queue, throws if the
     /// items exists beforehand. see contains().
@@ -43,10 +105,14 @@ class PQ {
     /// \param u item's value
     /// \param priority item's priority defaulted to 0 (top priority)
     void push(int u, int priority = 0) {
-        // add to items
-        if (not items.emplace(u, std::make_pair(u, priority)).second)
+        if (u < 0)
+            throw std::out_of_range(std::to_string(u) + " is negative");
+        if (contains(u))
             throw std::runtime_error(std::to_string(u) + " already exists");
-        pq.emplace(items.at(u)); // then add item to priority queue
+        if (u >= static_cast<int>(pos.size()))
+            pos.resize(std::max<std::size_t>(u + 1, pos.size() * 2), npos);
+        heap.emplace_back(u, priority);
+        sift_up(heap.size() - 1);
     }
 
     /// \brief Overload for handy usage (probably)
@@ -59,11 +125,15 @@ class PQ {
     /// \param u exciting item's value
     /// \param priority new priority
     void change_priority(int u, int priority) {
-        if (items.find(u) == std::end(items))
+        if (not contains(u))
             throw std::out_of_range(std::to_string(u) + " doesn't exist");
-        pq.erase(items.at(u));         // remove the item from the set
-        items.at(u).second = priority; // do the change
-        pq.emplace(items.at(u));       // add it to the set with new priority
+        const int i = pos[u];
+        const int old = heap[i].second;
+        heap[i].second = priority;
+        if (priority < old)
+            sift_up(i);
+        else
+            sift_down(i);
     }
 
     /// \brief Overload for handy usage
@@ -77,9 +147,13 @@ class PQ {
     void pop() {
         if (empty())
             throw std::runtime_error("Empty priority queue");
-        auto item = std::begin(pq)->get();
-        pq.erase(std::begin(pq));
-        items.erase(item.first);
+        pos[heap.front().first] = npos;
+        const item last = heap.back();
+        heap.pop_back();
+        if (not heap.empty()) {
+            heap.front() = last;
+            sift_down(0);
+        }
     }
 
     /// \brief get the item with top priority
@@ -88,7 +162,7 @@ class PQ {
     item top() const {
         if (empty())
             throw std::runtime_error("Empty priority queue");
-        return std::begin(pq)->get();
+        return heap.front();
     }
 
     /// \brief get certain item by its value, throws if the item is not found
@@ -97,63 +171,53 @@ class PQ {
     const item &retrieve(int u) const {
         if (not contains(u))
             throw std::out_of_range(std::to_string(u) + " doesn't exist");
-        return items.at(u);
+        return heap[pos[u]];
     }
 
     /// \return true if item's value is found, false otherwise
     bool contains(int u) const noexcept {
-        return items.find(u) != std::end(items);
+        return u >= 0 and u < static_cast<int>(pos.size()) and pos[u] != npos;
+    }
+
+    /// \brief removes all items, the reserved room is kept
+    void clear() noexcept {
+        for (const auto &it : heap)
+            pos[it.first] = npos;
+        heap.clear();
     }
 
     /// \return true is empty, false otherwise
-    bool empty() const noexcept { return pq.empty(); }
+    bool empty() const noexcept { return heap.empty(); }
 
     /// \brief
-    int size() const noexcept { return pq.size(); }
+    int size() const noexcept { return heap.size(); }
 
-    /// \brief an internal iterator implementation to iterate over the priority
-    /// queue items. to be used the range for loops
-    ///
-    /// it can incremented only, and dereferenced using wither `*` or `->`
-    class iterator {
-        using iterator_type = typename decltype(pq)::iterator;
-        iterator_type itr;
-
-        iterator &advance(int incr) { return std::advance(itr, incr), *this; }
-
-      public:
-        explicit iterator(iterator_type itr) : itr(itr) {}
-
-        const item &operator*() const noexcept { return itr->get(); }
-        const item &operator->() const noexcept { return itr->get(); }
-        bool operator==(const iterator &rhs) const { return itr == rhs.itr; }
-        bool operator!=(const iterator &rhs) const { return itr != rhs.itr; }
-        iterator operator++() { return advance(1); }
-        iterator &operator++(int) { return advance(1); }
-    };
+    /// \brief iterator over the priority queue items. items are visited in
+    /// heap order, only the first one is guaranteed to be the top
+    using iterator = typename std::vector<item>::const_iterator;
 
     /// \brief begin iterator of the priority queue
     ///
     /// \return iterator to the beginning of the priority queue
-    iterator begin() const { return iterator(std::begin(pq)); }
+    iterator begin() const { return std::begin(heap); }
 
     /// \brief end iterator to the end of the priority queue.
     /// it's not the last item, since end() is passed the last item
     ///
     /// \return iterator to the end of the priority queue
-    iterator end() const { return iterator(std::end(pq)); }
+    iterator end() const { return std::end(heap); }
 
     /// \brief unit testing for all functions of the class
     static void unit_testing() noexcept {
         std::cout << " ----------- Testing Priority Queue ---------------\n";
-        auto output = [](const std::string &msg, const PQ &Cont) {
+        auto output = [](const std::string &msg, const DaryPQ &Cont) {
             std::cout << "---- " << msg << " -----" << std::endl;
             for (const auto &e : Cont)
                 std::cout << e.first << " " << e.second << "\n";
             std::cout << "--------" << std::endl;
         };
 
-        PQ q;
+        DaryPQ q;
 
         for (auto to = 10, loop = 0; loop < to; ++loop) {
             auto u = loop, p = to - loop;
@@ -177,7 +241,21 @@ class PQ {
             q.pop();
         }
         output("priority queue afterwards", q);
+
+        for (auto to = 10, loop = 10; loop < 2 * to; ++loop)
+            q.push(loop, 7); // equal priorities should all be kept
+        std::cout << "size after pushing equal priorities: " << q.size()
+                  << "\n";
+        for (auto prev = q.top(); not q.empty(); q.pop()) {
+            if (cmp{}(q.top(), prev))
+                std::cout << "out of order: " << q.top().first << "\n";
+            prev = q.top();
+        }
     }
 };
 
+/// \brief the priority queue used throughout, a 4-ary heap keeps a few children
+/// in the same cache line while halving the depth of a binary heap
+using PQ = DaryPQ<4>;
+
 #endif /* PQ_H */
@@ -0,0 +1,110 @@
+#ifndef SEARCH_STATS_H
+#define SEARCH_STATS_H
+
+#include "perf_counters.hpp"
+
+#include <array>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+
+/// \brief counters and timings of one shortest path query
+///
+/// searches are templated over their stats, the hooks of search_stats::none
+/// are empty and get inlined away, so queries that are not measured pay
+/// nothing. a search given a search_stats calls its hooks as it goes, and
+/// lap() at the end of each phase. the counters add up if the same stats are
+/// passed to several queries. if hardware counters are attached, each phase
+/// also gets their deltas, see PerfCounters
+struct search_stats {
+    /// \brief phases of a query, in order
+    enum phase { init, search, trace, n_phases };
+
+    long settled = 0;   ///< vertices popped from the queue
+    long scanned = 0;   ///< edges looked at from settled vertices
+    long pushed = 0;    ///< vertices reached for the first time
+    long decreased = 0; ///< change_priority() calls on queued vertices
+    std::array<double, n_phases> us{}; ///< microseconds spent in each phase
+
+    PerfCounters *perf = nullptr; ///< hardware counters read at every lap
+    std::array<PerfCounters::sample, n_phases> events{}; ///< deltas by phase
+
+    /// \brief starts timing the first phase
+    void start() {
+        if (perf)
+            last_events = perf->read();
+        last = std::chrono::steady_clock::now();
+    }
+
+    /// \brief ends the phase p, and starts timing the next one
+    void lap(phase p) {
+        const auto now = std::chrono::steady_clock::now();
+        us[p] += std::chrono::duration<double, std::micro>(now - last).count();
+        if (perf) {
+            const auto counts = perf->read();
+            for (int e = 0; e < PerfCounters::n_events; ++e)
+                events[p][e] += counts[e] - last_events[e];
+            last_events = counts;
+        }
+        last = std::chrono::steady_clock::now(); // reading is not counted
+    }
+
+    void on_settle() { ++settled; }
+    void on_scan() { ++scanned; }
+    void on_push() { ++pushed; }
+    void on_decrease() { ++decreased; }
+
+    /// \brief same interface, but records nothing
+    struct none {
+        void start() {}
+        void lap(phase) {}
+        void on_settle() {}
+        void on_scan() {}
+        void on_push() {}
+        void on_decrease() {}
+    };
+
+  private:
+    std::chrono::steady_clock::time_point last; ///< end of the last phase
+    PerfCounters::sample last_events{};         ///< counts at the last lap
+};
+
+/// \brief distribution of search_stats over many queries, for long running
+/// processes to dump from time to time
+///
+/// every counter and timing has its own histogram of power of two buckets,
+/// bucket b holding the values in [2^(b - 1), 2^b) and bucket 0 the zeros.
+/// adding and dumping may happen from several threads
+class SearchHistogram {
+  public:
+    static constexpr int n_buckets = 48; ///< up to 2^47, larger values clamp
+    static constexpr int n_metrics = 4 + search_stats::n_phases;
+
+    /// \brief names of the metrics, counters first then phases in us
+    static const std::array<const char *, n_metrics> metrics;
+
+  private:
+    mutable std::mutex mtx;
+    long n_queries = 0;
+    std::array<std::array<long, n_buckets>, n_metrics> counts{};
+    std::array<double, n_metrics> sums{};
+
+  public:
+    /// \brief records the stats of one query
+    void add(const search_stats &stats);
+
+    /// \return number of queries recorded
+    long queries() const;
+
+    /// \brief writes csv lines "metric,queries,mean,lower,upper,count" for
+    /// every non empty bucket, with a header line
+    ///
+    /// \param out stream to write to
+    /// \param reset if true, forgets the recorded queries afterwards
+    void dump(std::ostream &out, bool reset = false);
+
+    /// \brief testing all class functions
+    static void unit_testing() noexcept;
+};
+
+#endif /* SEARCH_STATS_H */
@@ -1,8 +1,15 @@
 #ifndef SHORT_PATH_H
 #define SHORT_PATH_H
 
+#include "bucket_pq.hpp"
+#include "csr_graph.hpp"
 #include "graph.hpp"
 #include "pq.hpp"
+#include "search_stats.hpp"
+#include "thread_pool.hpp"
+
+#include <queue>
+#include <unordered_map>
 
 /// \brief helper structure to hold a path between two vertices
 ///
@@ -14,11 +21,18 @@ struct path {
 
     /// \brief constructor populating vertices vector and the total path cost
     ///
-    /// \param parent back trace indicating which edge we took
-    /// \param sink if a path was found, sink should have a predecessor
+    /// \param g graph the dense indices are of
+    /// \param parent back trace indicating which edge we took, by dense index
+    /// \param sink dense index of the sink, should have a predecessor if a
+    /// path was found
+    /// \param cost the sum of all edges
+    path(const Graph &g, const std::vector<int> &parent, int sink, int cost);
+
+    /// \brief constructor from an already traced sequence of vertices
+    ///
+    /// \param vertices vertices of the path, from the source to the sink
     /// \param cost the sum of all edges
-    path(const std::map<vertex_id, vertex_id> &parent, vertex_id sink,
-         int cost);
+    path(std::vector<vertex_id> vertices, int cost);
 
     int cost() const;                               ///< path cost accessor
     const std::vector<vertex_id> &vertices() const; ///< vertices accessor
@@ -28,6 +42,43 @@ struct path {
     int _cost = 0;
 };
 
+/// \brief helper structure to hold the shortest paths from one source to
+/// every vertex, as computed by Dijkstra::shortest_path_tree()
+///
+/// vertices are kept in dense arrays, along with their dense indices sorted by
+/// id, so each query costs a binary search for the vertex and then O(path
+/// length)
+struct path_tree {
+    path_tree() = default; ///< default constructor of an empty tree
+
+    /// \brief constructor taking over the dense arrays of a search
+    ///
+    /// \param ids id of each dense index
+    /// \param dist distance of each vertex from the source, -1 if unreachable
+    /// \param parent dense index of the predecessor of each vertex, -1 for
+    /// the source and the unreachable vertices
+    path_tree(std::vector<vertex_id> ids, std::vector<int> dist,
+              std::vector<int> parent);
+
+    bool reachable(vertex_id u) const; ///< true if there is a path to u
+    int cost(vertex_id u) const; ///< path cost to u, throws if unreachable
+
+    /// \brief back traces the path from the source to sink, throws if sink
+    /// is not in the graph
+    ///
+    /// \param sink vertex to go to
+    /// \return a path, if not path is found default is returned
+    path path_to(vertex_id sink) const;
+
+  private:
+    std::vector<vertex_id> ids;
+    std::vector<int> dist;
+    std::vector<int> parent;
+    std::vector<int> by_id; ///< dense indices in increasing order of their ids
+
+    int index(vertex_id u) const; ///< dense index of u, throws if not found
+};
+
 /// \brief Dijkstra's shortest path algorithm
 ///
 /// implementation uses a priority queue to prioritize which edges to take next
@@ -35,6 +86,58 @@ struct path {
 struct Dijkstra {
     const Graph &g; ///< graph constant reference
 
+    /// \brief priority queue driving the searches on snapshots
+    enum class queue {
+        automatic, ///< bucket when weights allow it, heap otherwise
+        heap,      ///< the indexed d-ary heap, see PQ
+        bucket,    ///< Dial's buckets, needs non-negative bounded weights
+    };
+
+    /// \brief heaviest edge for which bucket queues are picked automatically,
+    /// past that the circular array of buckets is mostly empty
+    static constexpr int max_bucket_span = 1 << 16;
+
+    /// \brief state of the searches, kept by every thread and reused across
+    /// queries. an entry is only valid if it was stamped during the current
+    /// epoch, so starting a query is O(1) rather than O(V) and back to back
+    /// queries only pay for the region they explore
+    class workspace {
+        std::vector<unsigned> stamp; ///< epoch in which each entry was set
+        std::vector<int> dist;       ///< distance of each dense index
+        std::vector<int> parent;     ///< predecessor of each dense index
+        unsigned epoch = 0;          ///< current query
+
+      public:
+        PQ heap;               ///< queue of the searches
+        BucketPQ buckets{0};   ///< queue of the bucket searches on snapshots
+
+        /// \brief starts a new query on a graph of n vertices, forgetting all
+        /// entries and emptying the heap. bucket searches size and empty the
+        /// buckets themselves
+        void reset(int n);
+
+        /// \return true if u was reached during the current query
+        bool reached(int u) const { return stamp[u] == epoch; }
+
+        /// \return distance of u, only valid if reached
+        int distance(int u) const { return dist[u]; }
+
+        /// \brief sets the distance and the predecessor of u
+        void reach(int u, int distance, int pred) {
+            stamp[u] = epoch, dist[u] = distance, parent[u] = pred;
+        }
+
+        /// \return predecessors by dense index, only valid along the back
+        /// trace of reached vertices
+        const std::vector<int> &parents() const { return parent; }
+
+        /// \brief the workspace of the calling thread, searches needing
+        /// several at once (such as the bidirectional one) use other slots
+        ///
+        /// \param slot 0 or 1
+        static workspace &local(int slot = 0);
+    };
+
     /// \brief constructor does nothing besides setting the graph
     ///
     /// \param graph in which we would operate
@@ -45,11 +148,86 @@ struct Dijkstra {
     ///
     /// \param source vertex to go from
     /// \param sink vertex to go to
+    /// \param stats if given, the counters and timings of the query are added
+    /// to it, otherwise nothing is measured
     /// \return a path, if not path is found default is returned
-    path find_path(vertex_id source, vertex_id sink);
+    path find_path(vertex_id source, vertex_id sink,
+                   search_stats *stats = nullptr);
+
+    /// \brief runs the search from the source to completion, every path from
+    /// the source is then extracted from the tree without searching again.
+    /// throws if the source is not found in the graph
+    ///
+    /// \param source vertex to go from
+    /// \return the distances and predecessors of all vertices
+    path_tree shortest_path_tree(vertex_id source);
+
+    /// \brief finds the paths of a batch of queries. queries sharing a source
+    /// are answered by one search, which stops once all their sinks are
+    /// settled, and searches are spread over a work stealing pool. throws if
+    /// any vertex is not found
+    ///
+    /// \param queries pairs of source and sink
+    /// \param n_threads number of threads sharing the searches
+    /// \return the path of each query, in the order of the queries
+    std::vector<path>
+    find_paths(const std::vector<std::pair<vertex_id, vertex_id>> &queries,
+               unsigned n_threads = std::thread::hardware_concurrency());
+
+    /// \brief same as find_paths(queries, n_threads), except it runs on an
+    /// existing pool to spare spawning threads for every batch
+    std::vector<path>
+    find_paths(const std::vector<std::pair<vertex_id, vertex_id>> &queries,
+               ThreadPool &pool);
+
+    /// \brief same as find_path(), except the per query state is a hash map
+    /// covering only the explored region, rather than the thread's workspace.
+    /// throws if either vertex is not found
+    ///
+    /// \param source vertex to go from
+    /// \param sink vertex to go to
+    /// \return a path, if not path is found default is returned
+    path find_path_lazy(vertex_id source, vertex_id sink);
+
+    /// \brief same as find_path(), except it searches forward from the
+    /// source and backward from the sink, over the predecessors of each
+    /// vertex, until both frontiers meet in the middle. throws if either
+    /// vertex is not found
+    ///
+    /// \param source vertex to go from
+    /// \param sink vertex to go to
+    /// \return a path, if not path is found default is returned
+    path find_path_bidirectional(vertex_id source, vertex_id sink);
+
+    /// \brief same as find_path(), except it runs on an immutable snapshot of
+    /// a graph, see Graph::freeze(). throws if either vertex is not found
+    ///
+    /// \param csr snapshot in which we would operate
+    /// \param source vertex to go from
+    /// \param sink vertex to go to
+    /// \param kind which priority queue to use, by default a bucket queue is
+    /// picked when all weights are non-negative and at most max_bucket_span
+    /// \param stats if given, the counters and timings of the query are added
+    /// to it
+    /// \return a path, if not path is found default is returned
+    static path find_path(const CsrGraph &csr, vertex_id source,
+                          vertex_id sink, queue kind = queue::automatic,
+                          search_stats *stats = nullptr);
 
     /// \brief testing all class functions
     static void unit_testing() noexcept;
+
+  private:
+    /// \brief runs the search from the source until all sinks are settled,
+    /// or all vertices if there are none. only the distances of settled
+    /// vertices are final
+    ///
+    /// \param source dense index of the vertex to go from
+    /// \param sinks dense indices of the vertices to go to
+    /// \return the workspace of the thread, holding the distances and
+    /// predecessors. it is shared by every search of the thread, so it is
+    /// only valid until the next one starts there
+    const workspace &settle(int source, const std::vector<int> &sinks) const;
 };
 
 #endif /* SHORT_PATH_H */
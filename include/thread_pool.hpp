@@ -0,0 +1,72 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/// \brief fixed set of worker threads running batches of indexed tasks
+///
+/// threads are spawned once and sleep between batches, so running many small
+/// batches does not pay for creating threads each time. each batch is split in
+/// one contiguous range of tasks per worker, which works through its own range
+/// in order and, once done, steals the upper half of the remaining range of
+/// another worker. uneven tasks are then balanced while each worker mostly
+/// touches neighboring tasks
+class ThreadPool {
+    /// \brief tasks left to a worker, [begin, end)
+    struct alignas(64) range {
+        std::mutex mtx;
+        int begin = 0, end = 0;
+    };
+
+    std::vector<std::thread> workers;
+    std::vector<range> ranges; ///< one per worker
+
+    std::mutex mtx;
+    std::condition_variable wake; ///< workers wait for a new batch on it
+    std::condition_variable done; ///< run() waits for the workers on it
+
+    const std::function<void(int)> *job = nullptr; ///< task of the batch
+    int running = 0;          ///< workers still busy with the batch
+    unsigned generation = 0;  ///< incremented with every batch
+    bool stopping = false;    ///< set when the pool is destroyed
+    std::exception_ptr error; ///< first exception thrown by a task
+
+    void work(unsigned id);
+
+    /// \brief takes the next task of the worker's range, stealing from the
+    /// others when it is empty
+    ///
+    /// \return the task index, -1 once no task is left in the batch
+    int next_task(unsigned id);
+
+  public:
+    /// \brief spawns the worker threads
+    ///
+    /// \param n_threads number of workers, at least one
+    explicit ThreadPool(
+        unsigned n_threads = std::thread::hardware_concurrency());
+
+    ThreadPool(const ThreadPool &) = delete;            ///< cannot be copied
+    ThreadPool &operator=(const ThreadPool &) = delete; ///< nor assigned
+
+    ~ThreadPool(); ///< joins the workers
+
+    /// \return number of workers
+    unsigned size() const noexcept { return workers.size(); }
+
+    /// \brief calls task(i) for every i in [0, n) across the workers and
+    /// waits for all of them. if any task throws, the first exception is
+    /// rethrown once the batch is over. batches should not be nested
+    ///
+    /// \param n number of tasks
+    /// \param task function called with the index of each task
+    void run(int n, const std::function<void(int)> &task);
+};
+
+#endif /* THREAD_POOL_H */
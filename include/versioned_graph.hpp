@@ -0,0 +1,140 @@
+#ifndef VERSIONED_GRAPH_H
+#define VERSIONED_GRAPH_H
+
+#include "csr_graph.hpp"
+
+#include <atomic>
+#include <mutex>
+
+/// \brief graph that is changed by writers while queries run on consistent
+/// snapshots of it, without locks on the read side
+///
+/// writers apply their changes in batches to a Graph, under a mutex, then
+/// publish a new version: a CsrGraph frozen from it, swapped in with a single
+/// atomic store. readers pin the current version and query it as long as they
+/// like, they never wait for a writer nor see half a batch. old versions are
+/// reclaimed by epochs: every publication bumps the global epoch, a reader
+/// records the epoch at which it pins, and a version retired at epoch e is
+/// freed once no reader is pinned at e or before. each query thread owns a
+/// reader, which holds one slot of the epoch table
+///
+/// publishing freezes the whole graph, so it pays for batching changes
+class VersionedGraph {
+  public:
+    /// \brief published state of the graph
+    struct version {
+        CsrGraph graph;       ///< snapshot of the graph
+        unsigned long number; ///< 0 for the first, then one per update
+    };
+
+  private:
+    /// \brief epoch table entry of a reader, on its own cache line so pinning
+    /// does not slow the other readers down
+    struct alignas(64) slot {
+        std::atomic<unsigned long> pinned{0}; ///< epoch pinned at, 0 if none
+        std::atomic<bool> taken{false};       ///< true if owned by a reader
+    };
+
+    Graph graph;       ///< latest state, only touched by writers
+    std::mutex writer; ///< one writer at a time
+    std::atomic<const version *> current{nullptr}; ///< latest published
+    std::atomic<unsigned long> epoch{1};           ///< bumped on publishing
+    std::atomic<unsigned long> published{0};       ///< number of current
+    std::vector<slot> slots;                       ///< one per reader at most
+    /// \brief versions replaced but maybe still read, with their epoch
+    std::vector<std::pair<unsigned long, std::unique_ptr<const version>>>
+        retired;
+
+    /// \brief freezes graph as the next version, then frees the retired ones
+    /// no reader can see anymore. the writer mutex should be held
+    void publish();
+
+    /// \brief rebuilds graph from the latest version, undoing the changes of
+    /// a batch that failed. the writer mutex should be held
+    void rollback();
+
+  public:
+    class reader;
+
+    /// \brief pinned version, stays valid and unchanged until destroyed
+    class snapshot {
+        reader *owner;      ///< reader pinned for it, nullptr once moved
+        const version *ver; ///< version read
+
+        snapshot(reader &owner, const version &ver);
+        friend class reader;
+
+      public:
+        snapshot(snapshot &&other) noexcept;
+        snapshot(const snapshot &) = delete;
+        snapshot &operator=(const snapshot &) = delete;
+        ~snapshot(); ///< unpins the reader, unless it holds other snapshots
+
+        /// \return the graph as it was published
+        const CsrGraph &graph() const noexcept { return ver->graph; }
+
+        /// \return number of the version
+        unsigned long number() const noexcept { return ver->number; }
+    };
+
+    /// \brief reading end of a query thread, a slot in the epoch table
+    class reader {
+        VersionedGraph &owner; ///< graph read
+        slot &own;             ///< slot taken
+        int depth = 0;         ///< snapshots alive, pinned while positive
+
+        friend class snapshot;
+
+      public:
+        /// \brief takes a free slot, throws if all are taken
+        explicit reader(VersionedGraph &graph);
+        reader(const reader &) = delete;
+        reader &operator=(const reader &) = delete;
+        ~reader(); ///< frees the slot, no snapshot should be left
+
+        /// \brief pins the latest version, in constant time and without locks.
+        /// a reader should stay on one thread, where snapshots may be nested
+        ///
+        /// \return snapshot of the latest version
+        snapshot read();
+    };
+
+    /// \brief publishes graph as the first version
+    ///
+    /// \param graph initial state of the graph
+    /// \param max_readers number of readers that may exist at once
+    explicit VersionedGraph(Graph graph, int max_readers = 64);
+
+    VersionedGraph(const VersionedGraph &) = delete;
+    VersionedGraph &operator=(const VersionedGraph &) = delete;
+    ~VersionedGraph(); ///< no reader should be left
+
+    /// \brief applies a batch of changes and publishes the result as a new
+    /// version. writers are serialized but readers go on meanwhile, on the
+    /// versions before. if changes throws, what it applied is rolled back to
+    /// the latest version, nothing is published and the exception is passed
+    /// on
+    ///
+    /// \param changes function called with the graph to change
+    /// \return number of the version published
+    template <typename Fn> unsigned long update(Fn &&changes) {
+        std::lock_guard<std::mutex> lock{writer};
+        try {
+            changes(graph);
+        } catch (...) {
+            rollback();
+            throw;
+        }
+        publish();
+        return published.load();
+    }
+
+    /// \return number of the latest version, which may be freed meanwhile so
+    /// it is kept apart from it
+    unsigned long latest() const noexcept { return published.load(); }
+
+    /// \brief testing all class functions
+    static void unit_testing() noexcept;
+};
+
+#endif /* VERSIONED_GRAPH_H */
@@ -0,0 +1,233 @@
+#include "all_pairs.hpp"
+
+#include <cmath>
+
+namespace {
+/// \brief min-plus product of the tiles a and b accumulated into c, that is
+/// c[i][j] = min(c[i][j], a[i][k] + b[k][j]) with k as the outer loop, so it
+/// stays correct when c is a or b as in Floyd-Warshall. when Hops is true the
+/// first hop of every improved pair is copied from the first hop of a
+///
+/// \param c tile to update, its first hops in c_next
+/// \param a tile of the first halves of the paths, its first hops in a_next
+/// \param b tile of the second halves of the paths
+/// \param stride row length of the matrices
+template <bool Hops>
+void relax_tile(int *c, int *c_next, const int *a, const int *a_next,
+                const int *b, int stride) {
+    constexpr int side = AllPairs::block;
+    for (int k = 0; k < side; ++k) {
+        const int *b_row = b + k * stride;
+        for (int i = 0; i < side; ++i) {
+            const int a_ik = a[i * stride + k];
+            if (a_ik >= AllPairs::inf) // no path i -> k to extend
+                continue;
+            int *c_row = c + i * stride;
+            if (Hops) {
+                const int hop = a_next[i * stride + k];
+                int *hop_row = c_next + i * stride;
+                for (int j = 0; j < side; ++j) {
+                    const int alt = a_ik + b_row[j];
+                    hop_row[j] = alt < c_row[j] ? hop : hop_row[j];
+                    c_row[j] = std::min(c_row[j], alt);
+                }
+            } else {
+                for (int j = 0; j < side; ++j)
+                    c_row[j] = std::min(c_row[j], a_ik + b_row[j]);
+            }
+        }
+    }
+}
+} // namespace
+
+AllPairs::AllPairs(const Graph &graph, bool next_hops, method how,
+                   unsigned n_threads) {
+    const CsrGraph csr = graph.freeze();
+    if (csr.min_weight() < 0)
+        throw std::runtime_error("negative edge weights");
+
+    n = csr.order();
+    stride = (n + block - 1) / block * block;
+    _ids.reserve(n);
+    for (int i = 0; i < n; ++i)
+        _ids.push_back(csr.identity(i));
+
+    if (how == method::automatic) {
+        // rough cost model: V^3 vectorized steps against V searches of
+        // (V + E) lg V heap operations, each of them worth many steps
+        const double v = n, e = csr.size();
+        how = (v + e) * std::log2(v + 1) * 64 < v * v ? method::dijkstra
+                                                      : method::floyd_warshall;
+    }
+    _used = how;
+
+    ThreadPool pool{n_threads};
+    _dist.assign(std::size_t(stride) * stride, inf);
+    if (next_hops)
+        _next.assign(_dist.size(), -1);
+    if (how == method::dijkstra) {
+        dijkstra(csr, pool);
+        return;
+    }
+
+    for (int i = 0; i < stride; ++i) {
+        _dist[i * stride + i] = 0;
+        if (next_hops)
+            _next[i * stride + i] = i;
+    }
+    for (int u = 0; u < n; ++u) {
+        for (int e = csr.first(u); e < csr.last(u); ++e) {
+            const int v = csr.target(e);
+            if (csr.weight(e) < _dist[u * stride + v]) {
+                _dist[u * stride + v] = csr.weight(e);
+                if (next_hops)
+                    _next[u * stride + v] = v;
+            }
+        }
+    }
+    floyd_warshall(pool);
+}
+
+void AllPairs::floyd_warshall(ThreadPool &pool) {
+    const int n_blocks = stride / block;
+    const bool hops = not _next.empty();
+    const auto relax = [this, hops](int ci, int cj, int ai, int aj, int bi,
+                                    int bj) {
+        const auto at = [this](int bi, int bj) {
+            return std::size_t(bi) * block * stride + bj * block;
+        };
+        int *c_next = hops ? &_next[at(ci, cj)] : nullptr;
+        const int *a_next = hops ? &_next[at(ai, aj)] : nullptr;
+        if (hops)
+            relax_tile<true>(&_dist[at(ci, cj)], c_next, &_dist[at(ai, aj)],
+                             a_next, &_dist[at(bi, bj)], stride);
+        else
+            relax_tile<false>(&_dist[at(ci, cj)], c_next, &_dist[at(ai, aj)],
+                              a_next, &_dist[at(bi, bj)], stride);
+    };
+
+    for (int kb = 0; kb < n_blocks; ++kb) {
+        // the diagonal tile only depends on itself
+        relax(kb, kb, kb, kb, kb, kb);
+        if (n_blocks == 1)
+            break;
+
+        // tiles of its row and column only depend on themselves and on it
+        pool.run(2 * (n_blocks - 1), [&](int t) {
+            const int other = t % (n_blocks - 1), b = other < kb ? other
+                                                                 : other + 1;
+            if (t < n_blocks - 1)
+                relax(kb, b, kb, kb, kb, b);
+            else
+                relax(b, kb, b, kb, kb, kb);
+        });
+
+        // the rest depend on the tiles of the row and the column
+        pool.run((n_blocks - 1) * (n_blocks - 1), [&](int t) {
+            int bi = t / (n_blocks - 1), bj = t % (n_blocks - 1);
+            bi += bi >= kb, bj += bj >= kb;
+            relax(bi, bj, bi, kb, kb, bj);
+        });
+    }
+}
+
+void AllPairs::dijkstra(const CsrGraph &csr, ThreadPool &pool) {
+    const bool hops = not _next.empty();
+    pool.run(n, [&](int src) {
+        int *dist = &_dist[std::size_t(src) * stride];
+        int *next = hops ? &_next[std::size_t(src) * stride] : nullptr;
+        std::vector<int> parent(n, -1);
+        PQ pq(n);
+
+        dist[src] = 0;
+        pq.push(src, 0);
+        while (not pq.empty()) {
+            auto [vert, prio] = pq.top();
+            pq.pop();
+            // parents are settled first, so their first hop is known
+            if (hops)
+                next[vert] = vert == src or parent[vert] == src
+                                 ? vert
+                                 : next[parent[vert]];
+            for (int e = csr.first(vert); e < csr.last(vert); ++e) {
+                const int nei = csr.target(e), alt = prio + csr.weight(e);
+                if (alt >= dist[nei])
+                    continue;
+                if (dist[nei] == inf)
+                    pq.push(nei, alt);
+                else
+                    pq.change_priority(nei, alt);
+                dist[nei] = alt;
+                parent[nei] = vert;
+            }
+        }
+    });
+}
+
+int AllPairs::index(vertex_id u) const {
+    auto itr = std::lower_bound(itr_range(_ids), u);
+    if (itr == std::end(_ids) or *itr != u)
+        throw std::runtime_error("vertex " + std::to_string(u) +
+                                 " is not in the graph");
+    return itr - std::begin(_ids);
+}
+
+bool AllPairs::reachable(vertex_id u, vertex_id v) const {
+    return row(index(u))[index(v)] != inf;
+}
+
+int AllPairs::cost(vertex_id u, vertex_id v) const {
+    if (not reachable(u, v))
+        throw std::out_of_range("no path from " + std::to_string(u) + " to " +
+                                std::to_string(v));
+    return row(index(u))[index(v)];
+}
+
+path AllPairs::find_path(vertex_id source, vertex_id sink) const {
+    if (_next.empty())
+        throw std::runtime_error("next hops were not kept");
+    const int src = index(source), dst = index(sink);
+    if (row(src)[dst] == inf)
+        return {};
+
+    std::vector<vertex_id> verts{source};
+    for (int tmp = src; tmp != dst; tmp = _next[tmp * stride + dst])
+        verts.push_back(_ids[_next[tmp * stride + dst]]);
+    return {std::move(verts), row(src)[dst]};
+}
+
+void AllPairs::unit_testing() noexcept {
+    for (double d : {0.02, 0.2, 0.4}) {
+        const Graph _g{150, d};
+        const CsrGraph csr = _g.freeze();
+
+        int mismatches = 0;
+        for (auto how : {method::floyd_warshall, method::dijkstra}) {
+            const AllPairs apsp{_g, true, how, 4};
+            for (int u = 0; u < csr.order(); ++u) {
+                const vertex_id from = csr.identity(u);
+                const path_tree tree = Dijkstra{_g}.shortest_path_tree(from);
+                for (int v = 0; v < csr.order(); ++v) {
+                    const vertex_id to = csr.identity(v);
+                    const path found = apsp.find_path(from, to);
+                    if (apsp.reachable(from, to) != tree.reachable(to) or
+                        found.cost() != tree.path_to(to).cost())
+                        ++mismatches;
+
+                    int cost = 0;
+                    const auto &verts = found.vertices();
+                    for (unsigned i = 1; i < verts.size(); ++i)
+                        cost += _g.weight({verts[i - 1], verts[i]});
+                    if (cost != found.cost())
+                        ++mismatches;
+                }
+            }
+        }
+        const AllPairs apsp{_g};
+        std::cout << "all pairs of " << csr.order() << " vertices and "
+                  << csr.size() << " edges solved by "
+                  << (apsp.used() == method::dijkstra ? "dijkstra"
+                                                      : "floyd-warshall")
+                  << ", mismatches: " << mismatches << "\n";
+    }
+}
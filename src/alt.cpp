@@ -0,0 +1,237 @@
+#include "alt.hpp"
+
+#include <cstring>
+#include <sstream>
+
+namespace {
+const char magic[4] = {'A', 'L', 'T', '1'}; ///< tag and version of the format
+
+/// \brief distances from src to every vertex of the snapshot, inf if
+/// unreachable
+std::vector<int> distances(const CsrGraph &csr, int src, int inf) {
+    std::vector<int> dist(csr.order(), inf);
+    PQ pq(csr.order());
+
+    dist[src] = 0;
+    pq.push(src, 0);
+    while (not pq.empty()) {
+        auto [vert, prio] = pq.top();
+        pq.pop();
+        for (int e = csr.first(vert); e < csr.last(vert); ++e) {
+            const int nei = csr.target(e);
+            const long long alt = (long long)prio + csr.weight(e);
+            if (alt < dist[nei]) { // then it fits in an int
+                if (dist[nei] == inf)
+                    pq.push(nei, alt);
+                else
+                    pq.change_priority(nei, alt);
+                dist[nei] = alt;
+            }
+        }
+    }
+    return dist;
+}
+
+template <typename T> void write(std::ostream &out, const T *data, int n) {
+    out.write(reinterpret_cast<const char *>(data), sizeof(T) * n);
+}
+
+template <typename T> void read(std::istream &in, T *data, int n) {
+    if (not in.read(reinterpret_cast<char *>(data), sizeof(T) * n))
+        throw std::runtime_error("landmark tables are truncated");
+}
+} // namespace
+
+Alt::Alt(const CsrGraph &csr, int n_landmarks)
+    : g(csr), k(std::min(std::max(n_landmarks, 0), csr.order())) {
+    const CsrGraph rev = g.reverse();
+    const int n = g.order();
+
+    _from.resize(n * k), _to.resize(n * k);
+    std::vector<int> closest(n, inf); // distance to the closest landmark
+    for (int l = 0; l < k; ++l) {
+        // the furthest vertex from all landmarks, unreachable ones first
+        const int landmark =
+            l == 0 ? 0
+                   : std::max_element(itr_range(closest)) - std::begin(closest);
+        _landmarks.push_back(landmark);
+
+        const auto &from = distances(g, landmark, inf);
+        const auto &to = distances(rev, landmark, inf);
+        for (int v = 0; v < n; ++v) {
+            _from[v * k + l] = from[v], _to[v * k + l] = to[v];
+            closest[v] = std::min(closest[v], from[v]);
+        }
+    }
+}
+
+Alt::Alt(const CsrGraph &csr, std::istream &in) : g(csr) {
+    char tag[sizeof(magic)];
+    read(in, tag, sizeof(tag));
+    if (std::memcmp(tag, magic, sizeof(magic)))
+        throw std::runtime_error("not landmark tables");
+
+    int header[3]; // order, size and number of landmarks
+    read(in, header, 3);
+    if (header[0] != g.order() or header[1] != g.size())
+        throw std::runtime_error("landmark tables are of a different graph");
+    k = header[2];
+    if (k < 0 or k > g.order())
+        throw std::runtime_error("landmark tables are corrupt");
+
+    std::vector<vertex_id> ids(k);
+    read(in, ids.data(), k);
+    for (const auto &id : ids) {
+        if (not g.has_vertex(id))
+            throw std::runtime_error("landmark tables are corrupt");
+        _landmarks.push_back(g.index(id));
+    }
+
+    const std::size_t n_entries = std::size_t(g.order()) * k;
+    _from.resize(n_entries), _to.resize(n_entries);
+    read(in, _from.data(), _from.size());
+    read(in, _to.data(), _to.size());
+
+    // the bounds subtract entries, which should be distances
+    const auto negative = [](int d) { return d < 0; };
+    bool corrupt = std::any_of(itr_range(_from), negative) or
+                   std::any_of(itr_range(_to), negative);
+    for (int l = 0; l < k; ++l)
+        corrupt = corrupt or _from[_landmarks[l] * std::size_t(k) + l] != 0 or
+                  _to[_landmarks[l] * std::size_t(k) + l] != 0;
+    if (corrupt)
+        throw std::runtime_error("landmark tables are corrupt");
+}
+
+void Alt::save(std::ostream &out) const {
+    const int header[3] = {g.order(), g.size(), k};
+    const auto &ids = landmarks();
+
+    write(out, magic, sizeof(magic));
+    write(out, header, 3);
+    write(out, ids.data(), ids.size());
+    write(out, _from.data(), _from.size());
+    write(out, _to.data(), _to.size());
+    if (not out)
+        throw std::runtime_error("could not write landmark tables");
+}
+
+std::vector<vertex_id> Alt::landmarks() const {
+    std::vector<vertex_id> ids;
+    ids.reserve(k);
+    for (const auto &l : _landmarks)
+        ids.push_back(g.identity(l));
+    return ids;
+}
+
+int Alt::lower_bound(int u, int t) const {
+    int bound = 0;
+    if (k == 0)
+        return bound;
+    const int *u_from = &_from[u * k], *u_to = &_to[u * k];
+    const int *t_from = &_from[t * k], *t_to = &_to[t * k];
+    for (int l = 0; l < k; ++l) {
+        if (t_to[l] != inf) { // d(u, t) >= d(u, L) - d(t, L)
+            if (u_to[l] == inf) // t reaches L but u does not, so neither t
+                return inf;
+            bound = std::max(bound, u_to[l] - t_to[l]);
+        }
+        if (t_from[l] != inf and u_from[l] != inf) // >= d(L, t) - d(L, u)
+            bound = std::max(bound, t_from[l] - u_from[l]);
+    }
+    return bound;
+}
+
+path Alt::find_path(vertex_id source, vertex_id sink) const {
+    const int src = g.index(source), dst = g.index(sink);
+    auto &ws = Dijkstra::workspace::local(); // vertices not reached are far
+    auto &pq = ws.heap; // prioritized by distance plus the bound to the sink
+    ws.reset(g.order());
+
+    if (lower_bound(src, dst) == inf)
+        return {};
+    ws.reach(src, 0, -1);
+    pq.push(src, lower_bound(src, dst));
+    while (not pq.empty()) {
+        const int vert = pq.top().first;
+        pq.pop();
+        if (vert == dst)
+            break;
+        for (int e = g.first(vert); e < g.last(vert); ++e) {
+            const int nei = g.target(e);
+            const long long alt = (long long)ws.distance(vert) + g.weight(e);
+            if (alt < inf and (not ws.reached(nei) or alt < ws.distance(nei))) {
+                const int bound = lower_bound(nei, dst);
+                if (bound == inf) // the sink cannot be reached through nei
+                    continue;
+                // the bounds are consistent, settled vertices never improve
+                const int prio = std::min<long long>(alt + bound, inf);
+                if (not ws.reached(nei))
+                    pq.push(nei, prio);
+                else
+                    pq.change_priority(nei, prio);
+                ws.reach(nei, alt, vert);
+            }
+        }
+    }
+    if (not ws.reached(dst))
+        return {};
+
+    std::vector<vertex_id> verts;
+    for (int tmp = dst; tmp != -1; tmp = ws.parents()[tmp])
+        verts.push_back(g.identity(tmp));
+    std::reverse(itr_range(verts));
+    return {std::move(verts), ws.distance(dst)};
+}
+
+void Alt::unit_testing() noexcept {
+    const Graph _g{50, 0.1};
+    const CsrGraph csr = _g.freeze();
+    const Alt alt{csr, 4};
+
+    std::stringstream tables;
+    alt.save(tables);
+    const Alt loaded{csr, tables};
+
+    std::cout << "landmarks:";
+    for (const auto &l : loaded.landmarks())
+        std::cout << " " << l;
+    std::cout << "\n";
+
+    int mismatches = 0;
+    for (int u = 0; u < csr.order(); ++u) {
+        for (int v = 0; v < csr.order(); ++v) {
+            const vertex_id from = csr.identity(u), to = csr.identity(v);
+            const path expected = Dijkstra::find_path(csr, from, to);
+            if (alt.find_path(from, to).cost() != expected.cost() or
+                loaded.find_path(from, to).cost() != expected.cost())
+                ++mismatches;
+            if (not expected.vertices().empty() and
+                alt.lower_bound(u, v) > expected.cost())
+                ++mismatches;
+        }
+    }
+
+    // a path far costlier than any cap on distances, then corrupt tables
+    const int heavy = 4e8;
+    const CsrGraph chain =
+        Graph{{{0, 0}, {1, 0}, {2, 0}, {3, 0}},
+              {{{0, 1}, heavy}, {{1, 2}, heavy}, {{2, 3}, heavy}}}
+            .freeze();
+    const Alt far{chain, 1};
+    if (far.find_path(0, 3).cost() != 3 * heavy or
+        not far.find_path(3, 0).vertices().empty())
+        ++mismatches;
+    std::cout << "alt mismatches: " << mismatches << "\n";
+
+    std::stringstream corrupt;
+    far.save(corrupt);
+    std::string bytes = corrupt.str();
+    bytes[bytes.size() - 1] = '\xff'; // last distance to landmark is negative
+    try {
+        std::stringstream in{bytes};
+        Alt{chain, in};
+    } catch (const std::runtime_error &e) {
+        std::cout << e.what() << "\n";
+    }
+}
@@ -0,0 +1,328 @@
+#include "contraction.hpp"
+
+namespace {
+/// \brief the remaining graph while contracting, that is the original edges
+/// and the shortcuts between vertices that are not contracted yet
+class overlay {
+  public:
+    struct link {
+        int other; ///< dense index of the other end
+        int wei;   ///< weight of the edge
+        int mid;   ///< bypassed vertex of shortcuts, -1 otherwise
+    };
+
+    std::vector<std::vector<link>> out; ///< out edges of each vertex
+    std::vector<std::vector<link>> in;  ///< in edges of each vertex
+
+  private:
+    static constexpr int inf = std::numeric_limits<int>::max();
+    static constexpr int settle_limit = 500; ///< bounds each witness search
+
+    std::vector<int> dist;    ///< witness distances, inf when untouched
+    std::vector<int> touched; ///< vertices whose distance should be reset
+    PQ pq;                    ///< witness search queue
+
+    /// \brief Dijkstra's algorithm from u ignoring the vertex v, until either
+    /// limit is exceeded or too many vertices are settled. distances are left
+    /// in dist
+    void witness_search(int u, int v, long long limit) {
+        for (const auto &t : touched)
+            dist[t] = inf;
+        touched.clear();
+        pq.clear();
+
+        dist[u] = 0, touched.push_back(u);
+        pq.push(u, 0);
+        for (int settled = 0; not pq.empty() and settled < settle_limit;
+             ++settled) {
+            auto [vert, prio] = pq.top();
+            pq.pop();
+            if (prio > limit)
+                break;
+            for (const auto &l : out[vert]) {
+                const long long alt = (long long)prio + l.wei;
+                if (l.other == v or alt >= dist[l.other])
+                    continue; // otherwise alt fits in an int
+                if (dist[l.other] == inf)
+                    pq.push(l.other, alt), touched.push_back(l.other);
+                else
+                    pq.change_priority(l.other, alt);
+                dist[l.other] = alt;
+            }
+        }
+    }
+
+    /// \brief adds the edge u -> w or shortens it if it already exists
+    void add_shortcut(int u, int w, int wei, int mid) {
+        for (auto &l : out[u]) {
+            if (l.other != w)
+                continue;
+            if (wei < l.wei) {
+                l.wei = wei, l.mid = mid;
+                for (auto &r : in[w])
+                    if (r.other == u)
+                        r.wei = wei, r.mid = mid;
+            }
+            return;
+        }
+        out[u].push_back({w, wei, mid});
+        in[w].push_back({u, wei, mid});
+    }
+
+  public:
+    explicit overlay(const CsrGraph &csr)
+        : out(csr.order()), in(csr.order()), dist(csr.order(), inf),
+          pq(csr.order()) {
+        for (int u = 0; u < csr.order(); ++u) {
+            for (int e = csr.first(u); e < csr.last(u); ++e) {
+                if (csr.target(e) == u) // loops are never on shortest paths
+                    continue;
+                out[u].push_back({csr.target(e), csr.weight(e), -1});
+                in[csr.target(e)].push_back({u, csr.weight(e), -1});
+            }
+        }
+    }
+
+    /// \brief finds the shortcuts needed to contract v, and adds them unless
+    /// simulating
+    ///
+    /// \return number of shortcuts needed
+    int contract(int v, bool simulate) {
+        int n_shortcuts = 0, max_out = 0;
+        for (const auto &l : out[v])
+            max_out = std::max(max_out, l.wei);
+
+        for (const auto &from : in[v]) {
+            witness_search(from.other, v, (long long)from.wei + max_out);
+            for (const auto &to : out[v]) {
+                // paths too long for a distance are never reported, so
+                // neither are shortcuts for them
+                const long long via = (long long)from.wei + to.wei;
+                if (to.other == from.other or dist[to.other] <= via or
+                    via >= inf)
+                    continue; // a witness path avoids v
+                ++n_shortcuts;
+                if (not simulate)
+                    add_shortcut(from.other, to.other, via, v);
+            }
+        }
+        if (simulate)
+            return n_shortcuts;
+
+        // v is gone, so are its edges from the remaining vertices
+        const auto drop = [v](std::vector<link> &links) {
+            links.erase(std::remove_if(itr_range(links),
+                                       [v](const auto &l) {
+                                           return l.other == v;
+                                       }),
+                        std::end(links));
+        };
+        for (const auto &l : out[v])
+            drop(in[l.other]);
+        for (const auto &l : in[v])
+            drop(out[l.other]);
+        return n_shortcuts;
+    }
+};
+} // namespace
+
+ContractionHierarchy::ContractionHierarchy(const CsrGraph &csr)
+    : g(csr), _rank(csr.order(), -1) {
+    const int n = g.order();
+    overlay rest{g};
+    std::vector<int> deleted(n, 0); // contracted neighbors of each vertex
+    std::vector<std::vector<arc>> up(n), down(n);
+
+    const auto importance = [&](int v) {
+        return rest.contract(v, true) - int(rest.in[v].size()) -
+               int(rest.out[v].size()) + deleted[v];
+    };
+
+    PQ order(n);
+    for (int v = 0; v < n; ++v)
+        order.push(v, importance(v));
+    for (int next_rank = 0; not order.empty();) {
+        const int v = order.top().first;
+        order.pop();
+        // priorities are updated lazily, v is contracted only if it is still
+        // the least important once its own priority is refreshed
+        if (const int prio = importance(v);
+            not order.empty() and prio > order.top().second) {
+            order.push(v, prio);
+            continue;
+        }
+
+        // the remaining neighbors are all ranked above v
+        for (const auto &l : rest.out[v])
+            up[v].push_back({l.other, l.wei, l.mid}), ++deleted[l.other];
+        for (const auto &l : rest.in[v])
+            down[v].push_back({l.other, l.wei, l.mid}), ++deleted[l.other];
+        _shortcuts += rest.contract(v, false);
+        _rank[v] = next_rank++;
+    }
+
+    const auto pack = [n](const std::vector<std::vector<arc>> &arcs,
+                          std::vector<int> &offsets, std::vector<arc> &flat) {
+        offsets.reserve(n + 1);
+        offsets.push_back(0);
+        for (const auto &v_arcs : arcs) {
+            flat.insert(std::end(flat), itr_range(v_arcs));
+            offsets.push_back(flat.size());
+        }
+    };
+    pack(up, _up_offsets, _up);
+    pack(down, _down_offsets, _down);
+}
+
+int ContractionHierarchy::rank(vertex_id u) const { return _rank[g.index(u)]; }
+
+void ContractionHierarchy::unpack(int from, int to, int mid,
+                                  std::vector<vertex_id> &verts) const {
+    if (mid == -1) {
+        verts.push_back(g.identity(to));
+        return;
+    }
+    // both halves were edges of mid when it got contracted
+    for (int e = _down_offsets[mid]; e < _down_offsets[mid + 1]; ++e)
+        if (_down[e].target == from) {
+            unpack(from, mid, _down[e].mid, verts);
+            break;
+        }
+    for (int e = _up_offsets[mid]; e < _up_offsets[mid + 1]; ++e)
+        if (_up[e].target == to) {
+            unpack(mid, to, _up[e].mid, verts);
+            break;
+        }
+}
+
+path ContractionHierarchy::find_path(vertex_id source, vertex_id sink) const {
+    const int src = g.index(source), dst = g.index(sink);
+
+    /// \brief one direction of the search, in a workspace of the thread so
+    /// that it only touches the vertices it reaches
+    struct search {
+        const std::vector<int> &offsets;
+        const std::vector<arc> &arcs;
+        Dijkstra::workspace &ws;
+
+        search(const std::vector<int> &offsets, const std::vector<arc> &arcs,
+               Dijkstra::workspace &ws, int n, int root)
+            : offsets(offsets), arcs(arcs), ws(ws) {
+            ws.reset(n);
+            ws.reach(root, 0, -1);
+            ws.heap.push(root, 0);
+        }
+
+        int top() const { return ws.heap.empty() ? inf : ws.heap.top().second; }
+
+        int distance(int u) const {
+            return ws.reached(u) ? ws.distance(u) : inf;
+        }
+
+        /// \return bypassed vertex of the arc from u to v, -1 if original
+        int mid(int u, int v) const {
+            for (int e = offsets[u]; e < offsets[u + 1]; ++e)
+                if (arcs[e].target == v)
+                    return arcs[e].mid;
+            return -1;
+        }
+
+        /// \brief settles the next vertex and relaxes its upward edges
+        ///
+        /// \return the settled vertex
+        int step() {
+            const int vert = ws.heap.top().first;
+            ws.heap.pop();
+            for (int e = offsets[vert]; e < offsets[vert + 1]; ++e) {
+                const int nei = arcs[e].target;
+                const long long alt =
+                    (long long)ws.distance(vert) + arcs[e].wei;
+                if (alt >= distance(nei))
+                    continue;
+                if (not ws.reached(nei))
+                    ws.heap.push(nei, alt);
+                else
+                    ws.heap.change_priority(nei, alt);
+                ws.reach(nei, alt, vert);
+            }
+            return vert;
+        }
+    };
+
+    search fwd{_up_offsets, _up, Dijkstra::workspace::local(0), g.order(), src};
+    search bwd{_down_offsets, _down, Dijkstra::workspace::local(1), g.order(),
+               dst};
+    int best = inf, meet = -1;
+
+    // each direction goes on until it cannot improve on the best meeting
+    while (std::min(fwd.top(), bwd.top()) < best) {
+        auto &near = fwd.top() <= bwd.top() ? fwd : bwd;
+        const auto &far = &near == &fwd ? bwd : fwd;
+        const int vert = near.step();
+        const long long through =
+            (long long)near.distance(vert) + far.distance(vert);
+        if (through < best)
+            best = through, meet = vert;
+    }
+    if (meet == -1)
+        return {};
+
+    // edges from the source up to the meeting vertex, then down to the sink
+    const auto &up = fwd.ws.parents(), &down = bwd.ws.parents();
+    std::vector<std::pair<int, std::pair<int, int>>> edges; // {from, {to, mid}}
+    for (int tmp = meet; tmp != src; tmp = up[tmp])
+        edges.push_back({up[tmp], {tmp, fwd.mid(up[tmp], tmp)}});
+    std::reverse(itr_range(edges));
+    for (int tmp = meet; tmp != dst; tmp = down[tmp])
+        edges.push_back({tmp, {down[tmp], bwd.mid(down[tmp], tmp)}});
+
+    std::vector<vertex_id> verts{g.identity(src)};
+    for (const auto &[from, to_mid] : edges)
+        unpack(from, to_mid.first, to_mid.second, verts);
+    return {std::move(verts), best};
+}
+
+void ContractionHierarchy::unit_testing() noexcept {
+    for (double d : {0.05, 0.2}) {
+        const Graph _g{200, d};
+        const CsrGraph csr = _g.freeze();
+        const ContractionHierarchy ch{csr};
+
+        int mismatches = 0;
+        for (int u = 0; u < csr.order(); u += 7) {
+            for (int v = 0; v < csr.order(); ++v) {
+                const vertex_id from = csr.identity(u), to = csr.identity(v);
+                const path expected = Dijkstra::find_path(csr, from, to);
+                const path found = ch.find_path(from, to);
+                if (found.cost() != expected.cost() or
+                    found.vertices().empty() != expected.vertices().empty())
+                    ++mismatches;
+
+                // the unpacked path should only take edges of the graph
+                int cost = 0;
+                const auto &verts = found.vertices();
+                for (unsigned i = 1; i < verts.size(); ++i)
+                    cost += _g.weight({verts[i - 1], verts[i]});
+                if (cost != found.cost())
+                    ++mismatches;
+            }
+        }
+        std::cout << "hierarchy of " << csr.order() << " vertices and "
+                  << csr.size() << " edges has " << ch.shortcuts()
+                  << " shortcuts, mismatches: " << mismatches << "\n";
+    }
+
+    // paths far costlier than any cap on distances, and shortcuts too long
+    // for one, skipped as no path through them can be reported
+    const int heavy = 4e8, huge = 2e9;
+    const CsrGraph chain = Graph{{{0, 0}, {1, 0}, {2, 0}, {3, 0}, {4, 0}},
+                                 {{{0, 1}, heavy},
+                                  {{1, 2}, heavy},
+                                  {{2, 3}, heavy},
+                                  {{3, 4}, huge}}}
+                               .freeze();
+    const ContractionHierarchy ch{chain};
+    std::cout << "heavy path cost: " << ch.find_path(0, 3).cost()
+              << ", too long found: "
+              << not ch.find_path(0, 4).vertices().empty() << "\n";
+}
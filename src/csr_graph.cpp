@@ -0,0 +1,275 @@
+#include "csr_graph.hpp"
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <numeric>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+const char magic[4] = {'C', 'S', 'R', 'G'}; ///< tag of the format
+const std::uint32_t version = 1;            ///< bumped on layout changes
+const std::uint32_t byte_order = 0x01020304; ///< reads reversed if swapped
+
+/// \brief first bytes of the file, followed by the arrays. all fields are of
+/// 4 bytes so the arrays are aligned right after it
+struct header {
+    char magic[4];
+    std::uint32_t version, byte_order;
+    std::int32_t order, size, min_weight, max_weight;
+};
+static_assert(sizeof(header) == 28 and sizeof(int) == 4 and
+                  sizeof(edge_weight_t) == 4 and sizeof(vertex_id) == 4 and
+                  sizeof(vertex_value_t) == 4,
+              "the binary format expects 32 bits fields");
+
+template <typename T>
+void write(std::ostream &out, const flat_array<T> &array) {
+    out.write(reinterpret_cast<const char *>(array.data()),
+              sizeof(T) * array.size());
+}
+
+[[noreturn]] void fail(const std::string &msg) {
+    throw std::runtime_error(msg + ": " + std::strerror(errno));
+}
+} // namespace
+
+CsrGraph::CsrGraph(const Graph &graph) : _ids(graph.vertices()) {
+    const int n_vertices = _ids.size();
+    std::vector<int> offsets, targets;
+    std::vector<edge_weight_t> weights;
+    std::vector<vertex_value_t> values;
+
+    // dense indices of the graph to those of the snapshot, sorted by id
+    std::vector<int> rank(n_vertices);
+    for (int i = 0; i < n_vertices; ++i)
+        rank[graph.index(_ids[i])] = i;
+
+    values.reserve(n_vertices);
+    offsets.reserve(n_vertices + 1);
+    offsets.push_back(0);
+    for (const auto &u : _ids) {
+        const Vertex &vert = graph.at(graph.index(u));
+        values.push_back(vert.value());
+        for (const auto &e : vert.out()) {
+            targets.push_back(rank[e.index()]);
+            weights.push_back(e.weight());
+        }
+        offsets.push_back(targets.size());
+    }
+    targets.shrink_to_fit();
+    weights.shrink_to_fit();
+    if (not weights.empty()) {
+        auto [lo, hi] = std::minmax_element(itr_range(weights));
+        _min_weight = *lo, _max_weight = *hi;
+    }
+    _offsets = std::move(offsets), _targets = std::move(targets);
+    _weights = std::move(weights), _values = std::move(values);
+}
+
+bool CsrGraph::has_vertex(vertex_id u) const {
+    return std::binary_search(itr_range(_ids), u);
+}
+
+int CsrGraph::index(vertex_id u) const {
+    auto itr = std::lower_bound(itr_range(_ids), u);
+    if (itr == std::end(_ids) or *itr != u)
+        throw std::runtime_error("vertex " + std::to_string(u) +
+                                 " is not in the graph");
+    return itr - std::begin(_ids);
+}
+
+CsrGraph CsrGraph::reverse() const {
+    CsrGraph rev;
+    rev._ids = _ids, rev._values = _values, rev._file = _file;
+    rev._min_weight = _min_weight, rev._max_weight = _max_weight;
+    std::vector<int> targets(size());
+    std::vector<edge_weight_t> weights(size());
+
+    // counting sort of the edges by their sink
+    std::vector<int> offsets(order() + 1, 0);
+    for (const auto &v : _targets)
+        ++offsets[v + 1];
+    std::partial_sum(itr_range(offsets), std::begin(offsets));
+
+    std::vector<int> fill(std::begin(offsets), std::end(offsets) - 1);
+    for (int u = 0; u < order(); ++u) {
+        for (int e = first(u); e < last(u); ++e) {
+            const int slot = fill[target(e)]++;
+            targets[slot] = u;
+            weights[slot] = weight(e);
+        }
+    }
+    rev._offsets = std::move(offsets), rev._targets = std::move(targets);
+    rev._weights = std::move(weights);
+    return rev;
+}
+
+void CsrGraph::save(std::ostream &out) const {
+    header head;
+    std::memcpy(head.magic, magic, sizeof(magic));
+    head.version = version, head.byte_order = byte_order;
+    head.order = order(), head.size = size();
+    head.min_weight = _min_weight, head.max_weight = _max_weight;
+
+    out.write(reinterpret_cast<const char *>(&head), sizeof(head));
+    if (order() == 0) { // even empty, the offsets hold the first edge
+        const int first_edge = 0;
+        out.write(reinterpret_cast<const char *>(&first_edge), sizeof(int));
+    } else
+        write(out, _offsets);
+    write(out, _targets);
+    write(out, _weights);
+    write(out, _values);
+    write(out, _ids);
+    if (not out)
+        throw std::runtime_error("could not write the snapshot");
+}
+
+bool CsrGraph::consistent() const {
+    // searches index their state by offsets and targets, and index() looks
+    // ids up by bisection, the queues trust the weight range
+    for (int u = 0; u < order(); ++u)
+        if (first(u) > last(u) or (u and identity(u - 1) >= identity(u)))
+            return false;
+    for (int e = 0; e < size(); ++e)
+        if (target(e) < 0 or target(e) >= order() or
+            weight(e) < _min_weight or weight(e) > _max_weight)
+            return false;
+    return true;
+}
+
+CsrGraph CsrGraph::load(int fd, bool trusted) {
+    struct stat info;
+    if (fstat(fd, &info) == -1)
+        fail("cannot stat the snapshot");
+    const std::size_t len = info.st_size;
+    if (len < sizeof(header) + sizeof(int))
+        throw std::runtime_error("not a snapshot");
+
+    void *data = mmap(nullptr, len, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED)
+        fail("cannot map the snapshot");
+    CsrGraph csr;
+    csr._file.reset(data, [len](const void *addr) {
+        munmap(const_cast<void *>(addr), len);
+    });
+
+    const auto &head = *static_cast<const header *>(data);
+    if (std::memcmp(head.magic, magic, sizeof(magic)))
+        throw std::runtime_error("not a snapshot");
+    if (head.byte_order != byte_order)
+        throw std::runtime_error("snapshot of a different byte order");
+    if (head.version != version)
+        throw std::runtime_error("snapshot of unsupported version " +
+                                 std::to_string(head.version));
+    const std::size_t n = head.order, m = head.size;
+    if (head.order < 0 or head.size < 0 or
+        len != sizeof(header) + sizeof(int) * (3 * n + 2 * m + 1))
+        throw std::runtime_error("snapshot is truncated or corrupt");
+
+    const int *next = reinterpret_cast<const int *>(&head + 1);
+    const auto take = [&next](std::size_t count) {
+        return std::exchange(next, next + count);
+    };
+    csr._offsets = {take(n + 1), n + 1};
+    csr._targets = {take(m), m};
+    csr._weights = {take(m), m};
+    csr._values = {take(n), n};
+    csr._ids = {take(n), n};
+    csr._min_weight = head.min_weight, csr._max_weight = head.max_weight;
+    if (csr._offsets[0] != 0 or csr._offsets[n] != head.size or
+        not (trusted or csr.consistent()))
+        throw std::runtime_error("snapshot is truncated or corrupt");
+    return csr;
+}
+
+CsrGraph CsrGraph::load(const std::string &filename, bool trusted) {
+    const int fd = open(filename.c_str(), O_RDONLY);
+    if (fd == -1)
+        fail("cannot open " + filename);
+    try {
+        CsrGraph csr = load(fd, trusted);
+        close(fd);
+        return csr;
+    } catch (...) {
+        close(fd);
+        throw;
+    }
+}
+
+void CsrGraph::unit_testing() noexcept {
+    Graph g{50, 0.2};
+    CsrGraph csr = g.freeze();
+
+    std::cout << "snapshot has " << csr.order() << " vertices and "
+              << csr.size() << " edges, graph has " << g.vertices().size()
+              << " vertices and " << g.edges().size() << " edges\n";
+
+    int mismatches = 0;
+    for (int u = 0; u < csr.order(); ++u) {
+        const vertex_id from = csr.identity(u);
+        if (csr.value(u) != g.value(from))
+            ++mismatches;
+        for (int e = csr.first(u); e < csr.last(u); ++e) {
+            const vertex_id to = csr.identity(csr.target(e));
+            if (not g.adjacent(from, to) or
+                g.weight({from, to}) != csr.weight(e))
+                ++mismatches;
+        }
+    }
+
+    const CsrGraph rev = csr.reverse();
+    for (int u = 0; u < rev.order(); ++u)
+        for (int e = rev.first(u); e < rev.last(u); ++e)
+            if (g.weight({rev.identity(rev.target(e)), rev.identity(u)}) !=
+                rev.weight(e))
+                ++mismatches;
+
+    // the mapped snapshot should be the same, even once copied
+    std::FILE *file = std::tmpfile();
+    std::ostringstream out;
+    csr.save(out);
+    const std::string &bytes = out.str();
+    std::fwrite(bytes.data(), 1, bytes.size(), file);
+    std::fflush(file);
+    const CsrGraph mapped = load(fileno(file)), loaded = mapped;
+    std::fclose(file);
+    if (loaded.order() != csr.order() or loaded.size() != csr.size() or
+        loaded.min_weight() != csr.min_weight() or
+        loaded.max_weight() != csr.max_weight())
+        ++mismatches;
+    for (int u = 0; u < csr.order(); ++u) {
+        if (loaded.identity(u) != csr.identity(u) or
+            loaded.value(u) != csr.value(u) or
+            loaded.last(u) != csr.last(u))
+            ++mismatches;
+        for (int e = csr.first(u); e < csr.last(u); ++e)
+            if (loaded.target(e) != csr.target(e) or
+                loaded.weight(e) != csr.weight(e))
+                ++mismatches;
+    }
+    // a truncated file, then one whose first edge goes past the last vertex
+    std::string corrupt = bytes;
+    const int past = csr.order();
+    std::memcpy(&corrupt[sizeof(header) + sizeof(int) * (csr.order() + 1)],
+                &past, sizeof(int));
+    for (const auto &data : {bytes.substr(0, bytes.size() / 2), corrupt}) {
+        file = std::tmpfile();
+        std::fwrite(data.data(), 1, data.size(), file);
+        std::fflush(file);
+        try {
+            load(fileno(file));
+        } catch (const std::runtime_error &e) {
+            std::cout << e.what() << "\n";
+        }
+        std::fclose(file);
+    }
+    std::cout << "snapshot of " << bytes.size()
+              << " bytes, mismatches: " << mismatches << "\n";
+}
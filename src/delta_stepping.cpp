@@ -0,0 +1,165 @@
+#include "delta_stepping.hpp"
+
+#include <limits>
+
+namespace {
+const int inf = std::numeric_limits<int>::max(); ///< tentative distance
+
+/// \brief frontiers smaller than this are relaxed by the calling thread, waking
+/// the pool would cost more than the relaxations
+const int parallel_threshold = 512;
+
+/// \brief lowers the distance to alt if it is shorter
+///
+/// \return true if the distance was lowered
+bool lower(std::atomic<int> &dist, int alt) {
+    int cur = dist.load(std::memory_order_relaxed);
+    while (alt < cur)
+        if (dist.compare_exchange_weak(cur, alt, std::memory_order_relaxed))
+            return true;
+    return false;
+}
+} // namespace
+
+DeltaStepping::DeltaStepping(const CsrGraph &csr, int delta,
+                             unsigned n_threads)
+    : g(csr), delta(delta), pool(n_threads) {
+    if (g.min_weight() < 0)
+        throw std::runtime_error("negative edge weights");
+    if (this->delta <= 0) {
+        const int degree = g.order() ? std::max(g.size() / g.order(), 1) : 1;
+        this->delta = std::max(g.max_weight() / degree, 1);
+    }
+}
+
+void DeltaStepping::relax(const std::vector<int> &frontier, int lo, int hi,
+                          std::vector<std::atomic<int>> &dist,
+                          std::vector<std::vector<int>> &buckets) {
+    const int n_tasks = frontier.size() < std::size_t(parallel_threshold)
+                            ? 1
+                            : int(pool.size()) * 4;
+    std::vector<std::vector<int>> improved(n_tasks);
+    const auto task = [&](int t) {
+        const std::size_t begin = frontier.size() * t / n_tasks,
+                          end = frontier.size() * (t + 1) / n_tasks;
+        for (std::size_t i = begin; i < end; ++i) {
+            const int vert = frontier[i];
+            const int base = dist[vert].load(std::memory_order_relaxed);
+            for (int e = g.first(vert); e < g.last(vert); ++e)
+                if (g.weight(e) >= lo and g.weight(e) <= hi and
+                    lower(dist[g.target(e)], base + g.weight(e)))
+                    improved[t].push_back(g.target(e));
+        }
+    };
+    if (n_tasks == 1)
+        task(0);
+    else
+        pool.run(n_tasks, task);
+
+    // filed by their final distance of the phase, stale copies left in
+    // further buckets are skipped when those are processed
+    for (const auto &verts : improved) {
+        for (const auto &v : verts) {
+            const std::size_t b =
+                dist[v].load(std::memory_order_relaxed) / delta;
+            if (b >= buckets.size())
+                buckets.resize(b + 1);
+            buckets[b].push_back(v);
+        }
+    }
+}
+
+std::vector<int> DeltaStepping::distances(vertex_id source) {
+    const int src = g.index(source), n = g.order();
+    std::vector<std::atomic<int>> dist(n);
+    for (auto &d : dist)
+        d.store(inf, std::memory_order_relaxed);
+    std::vector<int> seen(n, -1);  // last bucket a vertex was settled in
+    std::vector<int> phase(n, -1); // last phase a vertex was relaxed in
+
+    std::vector<std::vector<int>> buckets(1);
+    dist[src] = 0;
+    buckets[0].push_back(src);
+
+    std::vector<int> frontier, settled;
+    for (std::size_t b = 0, n_phases = 0; b < buckets.size(); ++b) {
+        settled.clear();
+        while (not buckets[b].empty()) {
+            frontier.clear();
+            for (const auto &v : buckets[b]) {
+                if (dist[v] / delta != int(b) or phase[v] == int(n_phases))
+                    continue; // moved to a lower bucket, or a duplicate
+                phase[v] = n_phases;
+                frontier.push_back(v);
+                if (seen[v] != int(b))
+                    seen[v] = b, settled.push_back(v);
+            }
+            buckets[b].clear();
+            ++n_phases;
+            relax(frontier, 0, delta, dist, buckets);
+        }
+        // distances in the bucket are final, heavy edges lead past it
+        relax(settled, delta + 1, inf, dist, buckets);
+    }
+
+    std::vector<int> result(n);
+    for (int v = 0; v < n; ++v)
+        result[v] = dist[v] == inf ? unreachable : dist[v].load();
+    return result;
+}
+
+path_tree DeltaStepping::shortest_path_tree(vertex_id source) {
+    const int src = g.index(source), n = g.order();
+    auto dist = distances(source);
+    std::vector<int> parent(n, -1);
+    std::vector<vertex_id> ids;
+    ids.reserve(n);
+    for (int v = 0; v < n; ++v)
+        ids.push_back(g.identity(v));
+
+    // breadth first search over the tight edges, the tree it builds has no
+    // cycles even with edges of weight 0
+    std::vector<int> queue{src};
+    std::vector<bool> visited(n, false);
+    visited[src] = true;
+    for (std::size_t i = 0; i < queue.size(); ++i) {
+        const int vert = queue[i];
+        for (int e = g.first(vert); e < g.last(vert); ++e) {
+            const int nei = g.target(e);
+            if (visited[nei] or dist[vert] + g.weight(e) != dist[nei])
+                continue;
+            visited[nei] = true;
+            parent[nei] = vert;
+            queue.push_back(nei);
+        }
+    }
+    return {std::move(ids), std::move(dist), std::move(parent)};
+}
+
+void DeltaStepping::unit_testing() noexcept {
+    for (double d : {0.01, 0.1}) {
+        const Graph _g{400, d};
+        const CsrGraph csr = _g.freeze();
+        Dijkstra algo{_g};
+
+        int mismatches = 0;
+        for (int delta : {1, 0, 100, 1000}) {
+            DeltaStepping ds{csr, delta, 4};
+            for (int u = 0; u < csr.order(); u += 37) {
+                const vertex_id from = csr.identity(u);
+                const path_tree expected = algo.shortest_path_tree(from);
+                const path_tree found = ds.shortest_path_tree(from);
+                for (int v = 0; v < csr.order(); ++v) {
+                    const vertex_id to = csr.identity(v);
+                    if (found.path_to(to).cost() !=
+                            expected.path_to(to).cost() or
+                        found.reachable(to) != expected.reachable(to))
+                        ++mismatches;
+                }
+            }
+        }
+        std::cout << "delta stepping on " << csr.order() << " vertices and "
+                  << csr.size() << " edges, mismatches: " << mismatches
+                  << "\n";
+    }
+}
@@ -1,13 +1,11 @@
 #include "graph.hpp"
 
-Edge::Edge(vertex_pref from, vertex_pref to, const edge_weight_t &wei)
-    : _source(from), _sink(to), _wei(wei) {
-    if (not from or not to)
-        throw std::runtime_error("Vertex was null");
-}
+Edge::Edge(vertex_id to, int index, const edge_weight_t &wei)
+    : _sink(to), _index(index), _wei(wei) {}
 
-vertex_ptr Edge::from() const { return _source.lock(); }
-vertex_ptr Edge::to() const { return _sink.lock(); }
+vertex_id Edge::to() const { return _sink; }
+int Edge::index() const { return _index; }
+void Edge::index(int i) { _index = i; }
 
 const edge_weight_t &Edge::weight() const { return _wei; }
 void Edge::weight(const edge_weight_t &wei) { _wei = wei; }
@@ -1,29 +1,56 @@
 #include "graph.hpp"
+#include "csr_graph.hpp"
+#include "graph_builder.hpp"
 
 #include <iomanip>
 
 Graph::Graph(Graph &&other) noexcept
-    : _vertices(std::exchange(other._vertices, {})) {}
+    : _vertices(std::exchange(other._vertices, {})),
+      _indices(std::exchange(other._indices, {})) {}
 
-Graph::Graph(int n_vertices, double edge_density) {
+Graph::Graph(int n_vertices, double edge_density)
+    : Graph(n_vertices, edge_density,
+            std::chrono::system_clock::now().time_since_epoch().count()) {}
+
+Graph::Graph(int n_vertices, double edge_density, unsigned seed)
+    : Graph(n_vertices, edge_density, {1, 500}, seed) {}
+
+Graph::Graph(int n_vertices, double edge_density,
+             std::pair<edge_weight_t, edge_weight_t> distance_range,
+             unsigned seed) {
     if (edge_density > 1)
         throw std::runtime_error("edge_density > 1");
-    const unsigned seed =
-        std::chrono::system_clock::now().time_since_epoch().count();
+    const auto [min_dist, max_dist] = distance_range;
+    if (min_dist < 0 or min_dist > max_dist)
+        throw std::runtime_error("invalid distance range");
     std::default_random_engine gen(seed);
-    std::uniform_int_distribution<int> verts(1, n_vertices);
+    std::uniform_real_distribution<double> coin(0, 1);
     std::uniform_int_distribution<int> vals(1, 500);
+    std::uniform_int_distribution<edge_weight_t> dists(min_dist, max_dist);
 
-    int n_edges = edge_density * ((n_vertices * (n_vertices - 1)) / 2);
-    for (int i = 1; i <= n_vertices; ++i)
+    _vertices.reserve(std::max(n_vertices, 0));
+    for (int i = 1; i <= n_vertices; ++i) // vertex i has index i - 1
         add_vertex(i, vals(gen));
-
-    for (int i = 0; i < n_edges; ++i) {
-        vertex_id u, v;
-        do {
-            u = verts(gen), v = verts(gen);
-        } while (v == u or adjacent(u, v));
-        add_edge({u, v}, vals(gen));
+    if (edge_density <= 0)
+        return;
+
+    // candidate edges {v, w} with w < v are walked in order, the gap to the
+    // next one picked is geometric so each draw yields an edge (Batagelj and
+    // Brandes). both ends see their neighbors in increasing order, edges are
+    // then appended without looking for duplicates
+    const double log_q = std::log1p(-edge_density);
+    const double max_skip = double(n_vertices) * n_vertices;
+    long long v = 1, w = -1;
+    while (v < n_vertices) {
+        const double skip = std::floor(std::log1p(-coin(gen)) / log_q);
+        w += 1 + static_cast<long long>(std::min(skip, max_skip));
+        for (; w >= v and v < n_vertices; ++v)
+            w -= v;
+        if (v < n_vertices) {
+            const edge_weight_t wei = dists(gen);
+            append_link(v, w, wei);
+            append_link(w, v, wei);
+        }
     }
 }
 
@@ -33,83 +60,128 @@ Graph::Graph(
         &edges,
     bool directed) {
 
-    for (const auto &v : vertices)
-        add_vertex(v.first, v.second);
-    for (const auto &e : edges) {
-        if (directed)
-            add_directed_edge(e.first, e.second);
-        else
-            add_edge(e.first, e.second);
-    }
+    GraphBuilder builder{directed};
+    builder.add_vertices(vertices);
+    builder.add_edges(edges);
+    *this = builder.build();
 }
 
 Graph &Graph::operator=(Graph &&other) noexcept {
     if (this == &other)
         return *this;
-    _vertices.clear();
     _vertices = std::exchange(other._vertices, {});
+    _indices = std::exchange(other._indices, {});
     return *this;
 }
 
 std::vector<vertex_id> Graph::vertices() const {
     std::vector<vertex_id> nodes;
-    nodes.reserve(_vertices.size());
-    std::transform(itr_range(_vertices), std::back_inserter(nodes),
-                   [](const auto &pair) { return pair.second->identity(); });
+    nodes.reserve(_indices.size());
+    for (const auto &[u, _] : _indices)
+        nodes.push_back(u);
     return nodes;
 }
 
 std::vector<std::pair<vertex_id, vertex_id>> Graph::edges() const {
     std::vector<std::pair<vertex_id, vertex_id>> links;
-    std::for_each(itr_range(_vertices), [&links](const auto &pair) {
-        const auto &v_edges = pair.second->edges();
-        return std::transform(itr_range(v_edges), std::back_inserter(links),
-                              [](const auto &e) { return e; });
-    });
-    links.shrink_to_fit();
+    for (const auto &[u, i] : _indices)
+        for (const auto &e : _vertices[i].out())
+            links.emplace_back(u, e.to());
     return links;
 }
 
 bool Graph::has_vertex(vertex_id u) const {
-    return _vertices.find(u) != std::end(_vertices);
+    return _indices.find(u) != std::end(_indices);
+}
+
+int Graph::index(vertex_id u) const {
+    return vertex_check(true, u, "vertex ", u, " is not found");
+}
+
+std::optional<int> Graph::try_index(vertex_id u) const noexcept {
+    auto itr = _indices.find(u);
+    if (itr == std::end(_indices))
+        return std::nullopt;
+    return itr->second;
 }
 
 const vertex_value_t &Graph::value(vertex_id u) const {
-    vertex_check(true, u, "vertex ", u, " is not found");
-    return _vertices.at(u)->value();
+    return _vertices[vertex_check(true, u, "vertex ", u, " is not found")]
+        .value();
+}
+
+std::optional<vertex_value_t> Graph::try_value(vertex_id u) const noexcept {
+    if (auto i = try_index(u))
+        return _vertices[*i].value();
+    return std::nullopt;
 }
 
 void Graph::value(vertex_id u, const vertex_value_t &val) {
-    vertex_check(true, u, "vertex ", u, " is not found");
-    _vertices.at(u)->value(val);
+    _vertices[vertex_check(true, u, "vertex ", u, " is not found")].value(val);
 }
 
 std::vector<std::pair<vertex_id, vertex_id>> Graph::edges(vertex_id u) const {
-    vertex_check(true, u, "vertex ", u, " is not found");
-    return _vertices.at(u)->edges();
+    return _vertices[vertex_check(true, u, "vertex ", u, " is not found")]
+        .edges();
+}
+
+neighbor_view Graph::weighted_neighbors(vertex_id u) const {
+    return neighbor_view{
+        _vertices[vertex_check(true, u, "vertex ", u, " is not found")].out()};
 }
 
 std::vector<vertex_id> Graph::neighbors(vertex_id u) const {
-    vertex_check(true, u, "vertex ", u, " is not found");
-    return _vertices.at(u)->neighbors();
+    return _vertices[vertex_check(true, u, "vertex ", u, " is not found")]
+        .neighbors();
+}
+
+std::vector<vertex_id> Graph::predecessors(vertex_id u) const {
+    return _vertices[vertex_check(true, u, "vertex ", u, " is not found")]
+        .predecessors();
 }
 
 void Graph::add_vertex(vertex_id u, const vertex_value_t &val) {
-    vertex_check(false, u, "vertex ", u, " already exists");
-    _vertices.emplace(u, std::make_shared<Vertex>(u, val));
+    if (not try_add_vertex(u, val))
+        fail("vertex ", u, " already exists");
+}
+
+bool Graph::try_add_vertex(vertex_id u, const vertex_value_t &val) {
+    // ids are often added in increasing order, then the hint is right
+    const auto size = _indices.size();
+    _indices.emplace_hint(std::end(_indices), u, _vertices.size());
+    if (_indices.size() == size)
+        return false;
+    _vertices.emplace_back(u, val);
+    return true;
 }
 
 void Graph::remove_vertex(vertex_id u) {
-    vertex_check(true, u, "vertex ", u, " is not found");
-    for (const auto &[e1, e2] : edges(u))
-        remove_directed_edge({e2, e1});
-    _vertices.erase(u);
+    const int i = vertex_check(true, u, "vertex ", u, " is not found"),
+              last = _vertices.size() - 1;
+    for (const auto &e : _vertices[i].out())
+        _vertices[e.index()].remove_in(u);
+    for (const auto &e : _vertices[i].in())
+        _vertices[e.index()].remove_out(u);
+
+    // the last vertex takes the place of u, and its neighbors are told so
+    if (i != last) {
+        _vertices[i] = std::move(_vertices[last]);
+        const vertex_id moved = _vertices[i].identity();
+        const auto place = [i, last](int j) { return j == last ? i : j; };
+        for (const auto &e : _vertices[i].out())
+            _vertices[place(e.index())].relocate(moved, i);
+        for (const auto &e : _vertices[i].in())
+            _vertices[place(e.index())].relocate(moved, i);
+        _indices[moved] = i;
+    }
+    _vertices.pop_back();
+    _indices.erase(u);
 }
 
 bool Graph::adjacent(vertex_id from, vertex_id to) const {
-    vertex_check(true, from, "vertex ", from, " is not found");
+    const int i = vertex_check(true, from, "vertex ", from, " is not found");
     vertex_check(true, to, "vertex ", to, " is not found");
-    return _vertices.at(from)->adjacent(_vertices.at(to));
+    return _vertices[i].adjacent(to);
 }
 
 bool Graph::adjacent(std::pair<vertex_id, vertex_id> e) const {
@@ -118,12 +190,21 @@ bool Graph::adjacent(std::pair<vertex_id, vertex_id> e) const {
 
 const edge_weight_t &Graph::weight(std::pair<vertex_id, vertex_id> e) const {
     auto &&[from, to] = e;
-    vertex_check(true, from, "vertex ", from, " is not found");
+    const int i = vertex_check(true, from, "vertex ", from, " is not found");
     vertex_check(true, to, "vertex ", to, " is not found");
-    if (not adjacent(from, to))
+    const auto edge = _vertices[i].edge(to);
+    if (not edge)
         throw std::out_of_range("no edge between " + std::to_string(from) +
                                 " and " + std::to_string(to));
-    return _vertices.at(from)->edge(_vertices.at(to))->weight();
+    return edge->weight();
+}
+
+std::optional<edge_weight_t>
+Graph::try_weight(std::pair<vertex_id, vertex_id> e) const noexcept {
+    if (auto i = try_index(e.first))
+        if (auto edge = _vertices[*i].edge(e.second))
+            return edge->weight();
+    return std::nullopt;
 }
 
 void Graph::weight(std::pair<vertex_id, vertex_id> e,
@@ -131,18 +212,37 @@ void Graph::weight(std::pair<vertex_id, vertex_id> e,
     auto &&[from, to] = e;
     vertex_check(true, from, "vertex ", from, " is not found");
     vertex_check(true, to, "vertex ", to, " is not found");
-    if (not adjacent(from, to))
+    if (not try_weight(e, wei))
         throw std::out_of_range("no edge between " + std::to_string(from) +
                                 " and " + std::to_string(to));
-    _vertices.at(from)->edge(_vertices.at(to))->weight(wei);
+}
+
+bool Graph::try_weight(std::pair<vertex_id, vertex_id> e,
+                       const edge_weight_t &wei) {
+    auto &&[from, to] = e;
+    const auto i = try_index(from), j = try_index(to);
+    if (not i or not j)
+        return false;
+    const auto edge = _vertices[*i].edge(to);
+    if (not edge)
+        return false;
+    edge->weight(wei);
+    _vertices[*j].edge_from(from)->weight(wei); // reversed copy
+    return true;
 }
 
 void Graph::add_directed_edge(std::pair<vertex_id, vertex_id> e,
                               const edge_weight_t &wei) {
     auto &&[from, to] = e;
-    vertex_check(true, from, "vertex ", from, " is not found");
-    vertex_check(true, to, "vertex ", to, " is not found");
-    _vertices.at(from)->add_directed_edge(_vertices.at(to), wei);
+    const int i = vertex_check(true, from, "vertex ", from, " is not found"),
+              j = vertex_check(true, to, "vertex ", to, " is not found");
+    link(i, j, wei);
+}
+
+bool Graph::try_add_directed_edge(std::pair<vertex_id, vertex_id> e,
+                                  const edge_weight_t &wei) {
+    const auto i = try_index(e.first), j = try_index(e.second);
+    return i and j and link(*i, *j, wei);
 }
 
 void Graph::add_edge(std::pair<vertex_id, vertex_id> e,
@@ -159,11 +259,9 @@ void Graph::add_edge(std::pair<vertex_id, vertex_id> e,
 void Graph::create_directed_edge(std::pair<vertex_id, vertex_id> e,
                                  const edge_weight_t &wei) {
     auto &&[from, to] = e;
-    if (not has_vertex(from))
-        add_vertex(from, 0);
-    if (not has_vertex(to))
-        add_vertex(to, 0);
-    _vertices.at(from)->add_directed_edge(_vertices.at(to), wei);
+    try_add_vertex(from, 0);
+    try_add_vertex(to, 0);
+    link(_indices.at(from), _indices.at(to), wei);
 }
 
 void Graph::create_edge(std::pair<vertex_id, vertex_id> e,
@@ -179,24 +277,52 @@ void Graph::create_edge(std::pair<vertex_id, vertex_id> e,
 
 void Graph::remove_edge(std::pair<vertex_id, vertex_id> e) {
     auto &&[from, to] = e;
-    vertex_check(true, from, "vertex ", from, " is not found");
-    vertex_check(true, to, "vertex ", to, " is not found");
-    if (not adjacent(from, to))
+    const int i = vertex_check(true, from, "vertex ", from, " is not found"),
+              j = vertex_check(true, to, "vertex ", to, " is not found");
+    if (not unlink(i, j))
         throw std::out_of_range("no edge between " + std::to_string(from) +
                                 " and " + std::to_string(to));
-    _vertices.at(from)->remove_edge(_vertices.at(to));
+    unlink(j, i);
 }
 
 void Graph::remove_directed_edge(std::pair<vertex_id, vertex_id> e) {
     auto &&[from, to] = e;
-    vertex_check(true, from, "vertex ", from, " is not found");
-    vertex_check(true, to, "vertex ", to, " is not found");
-    if (not adjacent(from, to))
+    const int i = vertex_check(true, from, "vertex ", from, " is not found"),
+              j = vertex_check(true, to, "vertex ", to, " is not found");
+    if (not unlink(i, j))
         throw std::out_of_range("no edge between " + std::to_string(from) +
                                 " and " + std::to_string(to));
-    _vertices.at(from)->remove_directed_edge(_vertices.at(to));
 }
 
+bool Graph::try_remove_directed_edge(std::pair<vertex_id, vertex_id> e) {
+    const auto i = try_index(e.first), j = try_index(e.second);
+    return i and j and unlink(*i, *j);
+}
+
+bool Graph::link(int from, int to, const edge_weight_t &wei) {
+    auto &u = _vertices[from], &v = _vertices[to];
+    if (not u.add_out({v.identity(), to, wei}))
+        return false;
+    v.add_in(u.identity(), from, wei);
+    return true;
+}
+
+void Graph::append_link(int from, int to, const edge_weight_t &wei) {
+    auto &u = _vertices[from], &v = _vertices[to];
+    u.append_out({v.identity(), to, wei});
+    v.append_in(u.identity(), from, wei);
+}
+
+bool Graph::unlink(int from, int to) {
+    auto &u = _vertices[from], &v = _vertices[to];
+    if (not u.remove_out(v.identity()))
+        return false;
+    v.remove_in(u.identity());
+    return true;
+}
+
+CsrGraph Graph::freeze() const { return CsrGraph{*this}; }
+
 void Graph::unit_testing() noexcept {
     Graph g;
 
@@ -317,4 +443,30 @@ void Graph::unit_testing() noexcept {
     Graph h = std::move(g);
     print_graph(g, "graph is only movable, should be empty", true, true);
     print_graph(h, "graph is only movable, should be old graph", true, true);
+
+    std::cout << "### non throwing variants ###\n" << std::boolalpha
+              << "try adding existing vertex 2: " << h.try_add_vertex(2, 0)
+              << "\ntry adding edge 2 -> 11: "
+              << h.try_add_directed_edge({2, 11}, 1)
+              << "\ntry weight of 2 -> 1: " << h.try_weight({2, 1}).value_or(-1)
+              << "\ntry weight of 1 -> 11: "
+              << h.try_weight({1, 11}).value_or(-1)
+              << "\ntry setting weight of 2 -> 1: " << h.try_weight({2, 1}, 42)
+              << ", now " << h.weight({2, 1})
+              << "\ntry removing edge 2 -> 11: "
+              << h.try_remove_directed_edge({2, 11})
+              << "\ntry index of 11: " << h.try_index(11).value_or(-1)
+              << "\ntry value of 3: " << h.try_value(3).value_or(-1) << "\n\n";
+
+    const Graph tiny = parse_algs4("4 5\n0 1 0.5\n1 2 1.25\n2 0 2\n0 1 9\n"
+                                   "3 3 .75\n",
+                                   true, 100);
+    print_graph(tiny, "parsing an algs4 graph, weights scaled by 100", true,
+                true);
+    for (const auto &text : {"2 1\n0 2\n", "2 1\n0 1 30000000.5\n"})
+        try {
+            parse_algs4(text, true, 100);
+        } catch (const std::runtime_error &e) {
+            std::cout << e.what() << std::endl;
+        }
 }
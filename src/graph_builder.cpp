@@ -0,0 +1,269 @@
+#include "graph_builder.hpp"
+#include "thread_pool.hpp"
+
+#include <numeric>
+
+namespace {
+/// \brief calls fn(c, begin, end) for each of the n_chunks slices [begin, end)
+/// of [0, n), on the pool if there is one
+void for_chunks(ThreadPool *pool, int n_chunks, std::size_t n,
+                const std::function<void(int, std::size_t, std::size_t)> &fn) {
+    const std::size_t step = (n + n_chunks - 1) / n_chunks;
+    const auto slice = [&](int c) {
+        fn(c, std::min(n, c * step), std::min(n, (c + 1) * step));
+    };
+    if (pool)
+        pool->run(n_chunks, slice);
+    else
+        for (int c = 0; c < n_chunks; ++c)
+            slice(c);
+}
+
+/// \brief stable counting sort of from into to, by a key in [0, n_keys).
+/// every chunk counts the keys of its slice, then scatters it right after the
+/// same keys of the chunks before, so equal keys stay in order
+template <typename Entry>
+void counting_sort(const std::vector<Entry> &from, std::vector<Entry> &to,
+                   int n_keys, int Entry::*key, ThreadPool *pool,
+                   int n_chunks) {
+    std::vector<std::size_t> offsets(std::size_t(n_chunks) * n_keys, 0);
+    for_chunks(pool, n_chunks, from.size(),
+               [&](int c, std::size_t begin, std::size_t end) {
+                   std::size_t *count = &offsets[std::size_t(c) * n_keys];
+                   for (auto i = begin; i < end; ++i)
+                       ++count[from[i].*key];
+               });
+    std::size_t sum = 0;
+    for (int k = 0; k < n_keys; ++k)
+        for (int c = 0; c < n_chunks; ++c)
+            sum += std::exchange(offsets[std::size_t(c) * n_keys + k], sum);
+    for_chunks(pool, n_chunks, from.size(),
+               [&](int c, std::size_t begin, std::size_t end) {
+                   std::size_t *offset = &offsets[std::size_t(c) * n_keys];
+                   for (auto i = begin; i < end; ++i)
+                       to[offset[from[i].*key]++] = from[i];
+               });
+}
+} // namespace
+
+GraphBuilder::GraphBuilder(bool directed, unsigned n_threads)
+    : directed(directed), n_threads(n_threads) {}
+
+void GraphBuilder::reserve(std::size_t n_vertices, std::size_t n_edges) {
+    vertices.reserve(n_vertices);
+    entries.reserve(directed ? n_edges : 2 * n_edges);
+}
+
+void GraphBuilder::add_vertex(vertex_id u, const vertex_value_t &val) {
+    vertices.emplace_back(u, val);
+}
+
+void GraphBuilder::add_vertices(
+    const std::vector<std::pair<vertex_id, vertex_value_t>> &batch) {
+    vertices.insert(std::end(vertices), std::begin(batch), std::end(batch));
+}
+
+void GraphBuilder::add_edge(std::pair<vertex_id, vertex_id> e,
+                            const edge_weight_t &wei) {
+    // the way back right after, as Graph::add_edge() does
+    entries.push_back({e.first, e.second, wei});
+    if (not directed)
+        entries.push_back({e.second, e.first, wei});
+}
+
+void GraphBuilder::add_edges(const std::vector<edge> &batch) {
+    entries.reserve(entries.size() + (directed ? 1 : 2) * batch.size());
+    for (const auto &e : batch)
+        add_edge(e.first, e.second);
+}
+
+Graph GraphBuilder::build() {
+    const auto verts = std::exchange(vertices, {});
+    auto edges = std::exchange(entries, {});
+    const int n_vertices = verts.size();
+
+    // ids[r] and index[r] are the id and dense index of the vertex of rank r,
+    // in increasing order of ids. among equal ids the first added comes first
+    std::vector<int> index(n_vertices);
+    std::iota(std::begin(index), std::end(index), 0);
+    std::stable_sort(std::begin(index), std::end(index), [&](int a, int b) {
+        return verts[a].first < verts[b].first;
+    });
+    std::vector<vertex_id> ids(n_vertices);
+    int duplicate = n_vertices; // first vertex added twice
+    for (int r = 0; r < n_vertices; ++r) {
+        ids[r] = verts[index[r]].first;
+        if (r and ids[r] == ids[r - 1])
+            duplicate = std::min(duplicate, index[r]);
+    }
+    if (duplicate < n_vertices)
+        Graph::fail("vertex ", verts[duplicate].first, " already exists");
+
+    // ranks are found by subtracting when ids have no gaps
+    const bool contiguous =
+        n_vertices == 0 or long(ids.back()) - ids.front() == n_vertices - 1;
+    const auto rank = [&](vertex_id u) -> int {
+        if (contiguous)
+            return n_vertices and u >= ids.front() and u <= ids.back()
+                       ? u - ids.front()
+                       : -1;
+        const auto itr = std::lower_bound(std::begin(ids), std::end(ids), u);
+        return itr != std::end(ids) and *itr == u ? itr - std::begin(ids) : -1;
+    };
+
+    // the per chunk counts take n_vertices each, so there are no more chunks
+    // than it takes for them to be as large as the edges
+    int n_chunks = 1;
+    if (edges.size() >= parallel_threshold and n_threads > 1)
+        n_chunks = std::max<std::size_t>(
+            1, std::min<std::size_t>(n_threads, edges.size() /
+                                                    std::max(n_vertices, 1)));
+    std::unique_ptr<ThreadPool> pool;
+    if (n_chunks > 1)
+        pool = std::make_unique<ThreadPool>(n_chunks);
+
+    // ids to ranks, the first edge with an end missing is reported
+    std::vector<std::size_t> missing(n_chunks, edges.size());
+    for_chunks(pool.get(), n_chunks, edges.size(),
+               [&](int c, std::size_t begin, std::size_t end) {
+                   for (auto i = begin; i < end; ++i) {
+                       auto &e = edges[i];
+                       const int from = rank(e.from), to = rank(e.to);
+                       if (from == -1 or to == -1) {
+                           missing[c] = std::min(missing[c], i);
+                           continue;
+                       }
+                       e.from = from, e.to = to;
+                   }
+               });
+    const auto first_missing = *std::min_element(std::begin(missing),
+                                                  std::end(missing));
+    if (first_missing < edges.size()) {
+        const auto &e = edges[first_missing];
+        Graph::fail("vertex ", rank(e.from) == -1 ? e.from : e.to,
+                    " is not found");
+    }
+
+    // least significant digit first, by sink then by source, which leaves
+    // the edges in the order the adjacency is appended in and parallel edges
+    // in the order they were added
+    std::vector<entry> sorted(edges.size());
+    counting_sort(edges, sorted, n_vertices, &entry::to, pool.get(), n_chunks);
+    counting_sort(sorted, edges, n_vertices, &entry::from, pool.get(),
+                  n_chunks);
+    sorted = {};
+
+    Graph g;
+    g._vertices.reserve(n_vertices);
+    for (const auto &v : verts)
+        g._vertices.emplace_back(v.first, v.second);
+    for (int r = 0; r < n_vertices; ++r)
+        g._indices.emplace_hint(std::end(g._indices), ids[r], index[r]);
+
+    // parallel edges are dropped but the first, then every adjacency is
+    // sized before being filled
+    std::vector<std::pair<int, int>> degrees(n_vertices); // {out, in}
+    std::size_t n_kept = 0;
+    for (const auto &e : edges) {
+        if (n_kept and edges[n_kept - 1].from == e.from and
+            edges[n_kept - 1].to == e.to)
+            continue;
+        edges[n_kept++] = e;
+        ++degrees[e.from].first, ++degrees[e.to].second;
+    }
+    for (int r = 0; r < n_vertices; ++r)
+        g._vertices[index[r]].reserve(degrees[r].first, degrees[r].second);
+    for (std::size_t i = 0; i < n_kept; ++i)
+        g.append_link(index[edges[i].from], index[edges[i].to], edges[i].wei);
+    return g;
+}
+
+void GraphBuilder::unit_testing() noexcept {
+    // same vertices, in the same order, with the same adjacency
+    const auto same = [](const Graph &a, const Graph &b) {
+        const auto same_edges = [](const std::vector<Edge> &x,
+                                   const std::vector<Edge> &y) {
+            return std::equal(std::begin(x), std::end(x), std::begin(y),
+                              std::end(y), [](const Edge &e, const Edge &f) {
+                                  return e.to() == f.to() and
+                                         e.index() == f.index() and
+                                         e.weight() == f.weight();
+                              });
+        };
+        if (a.order() != b.order())
+            return false;
+        for (int i = 0; i < a.order(); ++i)
+            if (a.identity(i) != b.identity(i) or
+                a.at(i).value() != b.at(i).value() or
+                not same_edges(a.at(i).out(), b.at(i).out()) or
+                not same_edges(a.at(i).in(), b.at(i).in()))
+                return false;
+        return true;
+    };
+
+    // sparse shuffled ids, parallel edges and loops, in several batches
+    std::mt19937 gen(42);
+    const int n_vertices = 300;
+    std::vector<std::pair<vertex_id, vertex_value_t>> vertices;
+    for (int u = 0; u < n_vertices; ++u)
+        vertices.emplace_back(7 * u - 500, u);
+    std::shuffle(std::begin(vertices), std::end(vertices), gen);
+    std::uniform_int_distribution<int> pick(0, n_vertices - 1), wei(1, 500);
+    std::vector<edge> edges;
+    for (int i = 0; i < 5000; ++i)
+        edges.push_back({{vertices[pick(gen)].first,
+                          vertices[pick(gen) % 40].first},
+                         wei(gen)});
+
+    int mismatches = 0;
+    for (const bool directed : {true, false}) {
+        Graph one_by_one;
+        for (const auto &v : vertices)
+            one_by_one.add_vertex(v.first, v.second);
+        GraphBuilder builder{directed};
+        builder.add_vertices(vertices);
+        for (std::size_t i = 0; i < edges.size(); i += 1000) {
+            builder.add_edges({std::begin(edges) + i,
+                               std::begin(edges) + i + 1000});
+            for (std::size_t j = i; j < i + 1000; ++j)
+                if (directed)
+                    one_by_one.add_directed_edge(edges[j].first,
+                                                 edges[j].second);
+                else
+                    one_by_one.add_edge(edges[j].first, edges[j].second);
+        }
+        const Graph built = builder.build();
+        if (not same(built, one_by_one) or builder.size() != 0 or
+            not same(Graph{vertices, edges, directed}, one_by_one))
+            ++mismatches;
+    }
+    std::cout << "bulk built graphs mismatches: " << mismatches << "\n";
+
+    // large batches are sorted in chunks, to the same graph
+    GraphBuilder alone{true, 1}, together{true, 4};
+    for (int u = 0; u < 20000; ++u)
+        alone.add_vertex(u, 0), together.add_vertex(u, 0);
+    std::uniform_int_distribution<int> any(0, 19999);
+    for (std::size_t i = 0; i < parallel_threshold; ++i) {
+        const int u = any(gen), v = any(gen), w = wei(gen);
+        alone.add_edge({u, v}, w), together.add_edge({u, v}, w);
+    }
+    std::cout << "parallel sort mismatches: "
+              << not same(alone.build(), together.build()) << "\n";
+
+    // faults are reported as when adding one by one
+    const auto error = [](GraphBuilder &builder) {
+        try {
+            builder.build();
+        } catch (const std::runtime_error &e) {
+            return std::string(e.what());
+        }
+        return std::string("no error");
+    };
+    GraphBuilder twice;
+    twice.add_vertices({{1, 0}, {2, 0}, {3, 0}, {2, 0}, {1, 0}});
+    GraphBuilder missing{false};
+    missing.add_vertices({{1, 0}, {2, 0}});
+    missing.add_edges({{{1, 2}, 1}, {{2, 4}, 1}, {{3, 1}, 1}});
+    std::cout << error(twice) << "\n" << error(missing) << "\n";
+}
@@ -0,0 +1,163 @@
+#include "graph_builder.hpp"
+
+#include <cerrno>
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+/// \brief hand rolled parser of numbers over a text, unlike streams it
+/// neither locks nor looks up the locale for every character
+class scanner {
+    const char *p, *end;
+
+    static bool is_digit(char c) { return c >= '0' and c <= '9'; }
+
+    [[noreturn]] void fail(const char *expected) const {
+        throw std::runtime_error(std::string("malformed algs4 graph, ") +
+                                 expected + " expected");
+    }
+
+  public:
+    explicit scanner(std::string_view text)
+        : p(text.data()), end(text.data() + text.size()) {}
+
+    /// \return true if nothing but blanks is left on the line
+    bool line_end() {
+        while (p != end and (*p == ' ' or *p == '\t' or *p == '\r'))
+            ++p;
+        return p == end or *p == '\n';
+    }
+
+    /// \brief skips blanks and new lines then reads a non-negative integer
+    int integer() {
+        while (p != end and (*p == ' ' or *p == '\n' or *p == '\t' or
+                             *p == '\r'))
+            ++p;
+        if (p == end or not is_digit(*p))
+            fail("integer");
+        long n = 0;
+        for (; p != end and is_digit(*p); ++p)
+            if ((n = n * 10 + (*p - '0')) > INT_MAX)
+                fail("smaller integer");
+        return n;
+    }
+
+    /// \brief reads a decimal number on the current line, "-1.25" or "3."
+    double decimal() {
+        line_end();
+        const bool negative = p != end and *p == '-';
+        p += negative;
+        if (p == end or (not is_digit(*p) and *p != '.'))
+            fail("weight");
+        double n = 0, unit = 1;
+        for (; p != end and is_digit(*p); ++p)
+            n = n * 10 + (*p - '0');
+        if (p != end and *p == '.')
+            for (++p; p != end and is_digit(*p); ++p)
+                n += (*p - '0') * (unit /= 10);
+        return negative ? -n : n;
+    }
+
+    /// \brief reads a decimal weight on the current line, multiplied by scale
+    /// then rounded, which should fit in a weight
+    edge_weight_t weight(int scale) {
+        using limits = std::numeric_limits<edge_weight_t>;
+        const double wei = decimal() * scale;
+        if (not(wei > limits::min() - 0.5 and wei < limits::max() + 0.5))
+            fail("smaller weight");
+        return std::lround(wei);
+    }
+};
+
+/// \brief file descriptor mapped in memory, unmapped when going out of scope
+struct mapping {
+    void *data = MAP_FAILED;
+    std::size_t size = 0;
+
+    mapping(int fd, std::size_t len) : size(len) {
+        data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED)
+            throw std::runtime_error(std::string("cannot map the file: ") +
+                                     std::strerror(errno));
+        madvise(data, size, MADV_SEQUENTIAL);
+    }
+    mapping(const mapping &) = delete;
+    ~mapping() { munmap(data, size); }
+};
+} // namespace
+
+Graph Graph::parse_algs4(std::string_view text, bool directed, int scale) {
+    scanner in{text};
+    const int n_vertices = in.integer(), n_lines = in.integer();
+
+    // vertex u has index u, the builder sorts the edges and sizes the
+    // adjacency before filling it. the header is not trusted to reserve more
+    // lines than the text holds, at least 4 bytes each
+    GraphBuilder builder{directed};
+    builder.reserve(n_vertices,
+                    std::min<std::size_t>(n_lines, text.size() / 4));
+    for (int u = 0; u < n_vertices; ++u)
+        builder.add_vertex(u, 0);
+    for (int i = 0; i < n_lines; ++i) {
+        const int u = in.integer(), v = in.integer();
+        for (const auto &w : {u, v})
+            if (w >= n_vertices)
+                throw std::runtime_error("vertex " + std::to_string(w) +
+                                         " is not in the graph");
+        const edge_weight_t wei = in.line_end() ? scale : in.weight(scale);
+        builder.add_edge({u, v}, wei);
+    }
+    return builder.build();
+}
+
+Graph Graph::load_algs4(int fd, bool directed, int scale) {
+    struct stat info;
+    if (fstat(fd, &info) == -1)
+        throw std::runtime_error(std::string("cannot stat the file: ") +
+                                 std::strerror(errno));
+    if (S_ISREG(info.st_mode) and info.st_size > 0) {
+        const mapping file{fd, std::size_t(info.st_size)};
+        return parse_algs4({static_cast<const char *>(file.data), file.size},
+                           directed, scale);
+    }
+
+    std::string text;
+    for (std::size_t len = 0;; len = text.size()) {
+        text.resize(len + (1 << 20));
+        const ssize_t n = read(fd, &text[len], 1 << 20);
+        if (n == -1 and errno == EINTR) {
+            text.resize(len);
+            continue;
+        }
+        if (n == -1)
+            throw std::runtime_error(std::string("cannot read the file: ") +
+                                     std::strerror(errno));
+        text.resize(len + n);
+        if (n == 0)
+            break;
+    }
+    return parse_algs4(text, directed, scale);
+}
+
+Graph Graph::load_algs4(const std::string &filename, bool directed,
+                        int scale) {
+    const int fd = open(filename.c_str(), O_RDONLY);
+    if (fd == -1)
+        throw std::runtime_error("cannot open " + filename + ": " +
+                                 std::strerror(errno));
+    try {
+        Graph g = load_algs4(fd, directed, scale);
+        close(fd);
+        return g;
+    } catch (...) {
+        close(fd);
+        throw;
+    }
+}
@@ -1,8 +1,78 @@
-#include "short_path.hpp"
+#include "all_pairs.hpp"
+#include "alt.hpp"
+#include "contraction.hpp"
+#include "delta_stepping.hpp"
+#include "graph_builder.hpp"
+#include "monte_carlo.hpp"
+#include "versioned_graph.hpp"
 
-int main(int, char const *[]) {
+#include <fstream>
+
+#include <unistd.h>
+
+/// \brief maps the file if it is a snapshot (.csr), otherwise parses it as an
+/// algs4 graph, "-" being the standard input
+static CsrGraph snapshot_of(const std::string &filename) {
+    const std::string ext = ".csr";
+    if (filename.size() > ext.size() and
+        filename.compare(filename.size() - ext.size(), ext.size(), ext) == 0)
+        return CsrGraph::load(filename);
+    const Graph g = filename == "-" ? Graph::load_algs4(STDIN_FILENO)
+                                    : Graph::load_algs4(filename);
+    return g.freeze();
+}
+
+/// \brief loads the graph file and reports the shortest paths from its first
+/// vertex, the snapshot is saved if a file is given for it
+static void shortest_paths_of(const std::string &filename,
+                              const char *save_to) {
+    using clock = std::chrono::steady_clock;
+    const auto start = clock::now();
+    const CsrGraph csr = snapshot_of(filename);
+    const std::chrono::duration<double, std::milli> loading =
+        clock::now() - start;
+    std::cout << filename << " has " << csr.order() << " vertices and "
+              << csr.size() << " edges, loaded in " << loading.count()
+              << " ms\n";
+    if (save_to) {
+        std::ofstream out{save_to, std::ios::binary};
+        csr.save(out);
+    }
+    if (csr.order() == 0)
+        return;
+
+    const auto &dist = DeltaStepping{csr}.distances(csr.identity(0));
+    std::pair<long, int> avg = {0, 0};
+    for (int v = 1; v < csr.order(); ++v)
+        if (dist[v] != DeltaStepping::unreachable)
+            avg.first += dist[v], avg.second++;
+    std::cout << avg.second << " vertices are reachable from "
+              << csr.identity(0) << " with average path cost: "
+              << (avg.second ? double(avg.first) / avg.second : 0) << "\n";
+}
+
+int main(int argc, char const *argv[]) {
+    if (argc > 1) {
+        try {
+            shortest_paths_of(argv[1], argc > 2 ? argv[2] : nullptr);
+        } catch (const std::exception &e) {
+            std::cerr << argv[1] << ": " << e.what() << "\n";
+            return 1;
+        }
+        return 0;
+    }
     // Graph::unit_testing();
     // PQ::unit_testing();
+    // BucketPQ::unit_testing();
+    // CsrGraph::unit_testing();
+    // Alt::unit_testing();
+    // ContractionHierarchy::unit_testing();
+    // AllPairs::unit_testing();
+    // DeltaStepping::unit_testing();
+    // SearchHistogram::unit_testing();
+    // GraphBuilder::unit_testing();
+    // VersionedGraph::unit_testing();
     Dijkstra::unit_testing();
+    MonteCarlo::unit_testing();
     return 0;
 }
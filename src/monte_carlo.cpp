@@ -0,0 +1,78 @@
+#include "monte_carlo.hpp"
+
+#include <cmath>
+
+unsigned MonteCarlo::stream_seed(std::uint64_t seed, std::uint64_t index) {
+    std::uint64_t z = seed + (index + 1) * 0x9e3779b97f4a7c15ull;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    z = z ^ (z >> 31);
+    return z ^ (z >> 32);
+}
+
+MonteCarlo::trial MonteCarlo::run_trial(const config &conf, int index) {
+    const Graph g{conf.n_vertices, conf.edge_density, conf.distance_range,
+                  stream_seed(conf.seed, index)};
+    const auto &verts = g.vertices();
+    trial t;
+    t.n_edges = g.edges().size();
+    if (verts.empty())
+        return t;
+
+    const path_tree tree = Dijkstra{g}.shortest_path_tree(verts.front());
+    for (unsigned j = 1; j < verts.size(); ++j)
+        if (tree.reachable(verts[j]))
+            t.total_cost += tree.cost(verts[j]), ++t.n_paths;
+    return t;
+}
+
+MonteCarlo::summary MonteCarlo::run(const config &conf) {
+    std::vector<trial> trials(std::max(conf.n_trials, 0));
+    ThreadPool pool{conf.n_threads};
+    pool.run(trials.size(),
+             [&](int index) { trials[index] = run_trial(conf, index); });
+
+    // aggregated in trial order, floating point sums do not depend on which
+    // thread finished first
+    summary sum;
+    double sum_sq = 0, edges = 0;
+    for (const auto &t : trials) {
+        edges += t.n_edges;
+        if (t.n_paths == 0) // no path at all, omitted like unreachable ones
+            continue;
+        const double avg = double(t.total_cost) / t.n_paths;
+        sum.min = sum.n_trials ? std::min(sum.min, avg) : avg;
+        sum.max = sum.n_trials ? std::max(sum.max, avg) : avg;
+        sum.mean += avg, sum_sq += avg * avg;
+        ++sum.n_trials;
+    }
+    if (not trials.empty())
+        sum.mean_edges = edges / trials.size();
+    if (sum.n_trials) {
+        sum.mean /= sum.n_trials;
+        const double var = sum_sq / sum.n_trials - sum.mean * sum.mean;
+        sum.stddev = std::sqrt(std::max(0., var));
+    }
+    return sum;
+}
+
+void MonteCarlo::unit_testing() noexcept {
+    for (double d : {0.2, 0.4}) {
+        config conf;
+        conf.edge_density = d, conf.seed = 2020;
+
+        const summary all = run(conf);
+        conf.n_threads = 1;
+        const summary one = run(conf);
+
+        std::cout << "density " << d << " over " << all.n_trials
+                  << " graphs of " << conf.n_vertices << " vertices and "
+                  << all.mean_edges << " edges on average has path cost: "
+                  << all.mean << " (stddev " << all.stddev << ", min "
+                  << all.min << ", max " << all.max << ")"
+                  << (all.mean == one.mean and all.stddev == one.stddev
+                          ? ""
+                          : " differs on a single thread!")
+                  << "\n";
+    }
+}
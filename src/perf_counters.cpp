@@ -0,0 +1,63 @@
+#include "perf_counters.hpp"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+const std::array<const char *, PerfCounters::n_events> PerfCounters::names = {
+    "cycles", "instructions", "llc_misses", "branch_misses"};
+
+PerfCounters::PerfCounters() {
+    fds.fill(-1);
+#ifdef __linux__
+    const unsigned long long configs[n_events] = {
+        PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+
+    for (int e = 0; e < n_events; ++e) {
+        perf_event_attr attr{};
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = configs[e];
+        attr.disabled = e == cycles; // the leader starts the whole group
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED |
+                           PERF_FORMAT_TOTAL_TIME_RUNNING;
+        fds[e] = syscall(SYS_perf_event_open, &attr, 0, -1, fds[cycles], 0);
+        if (fds[cycles] == -1) // without a leader there is no group
+            return;
+    }
+    ioctl(fds[cycles], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(fds[cycles], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#endif
+}
+
+PerfCounters::~PerfCounters() {
+#ifdef __linux__
+    for (const auto &fd : fds)
+        if (fd != -1)
+            close(fd);
+#endif
+}
+
+PerfCounters::sample PerfCounters::read() const {
+    sample counts{};
+#ifdef __linux__
+    if (not available())
+        return counts;
+    // number of events, times enabled and running, then one value per event
+    // in the order they joined the group
+    unsigned long long buf[3 + n_events] = {};
+    if (::read(fds[cycles], buf, sizeof(buf)) <= 0 or buf[2] == 0)
+        return counts;
+    const double scale = double(buf[1]) / buf[2];
+    for (int e = 0, i = 3; e < n_events and i < 3 + int(buf[0]); ++e)
+        if (has(event(e)))
+            counts[e] = static_cast<long long>(buf[i++] * scale);
+#endif
+    return counts;
+}
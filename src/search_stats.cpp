@@ -0,0 +1,85 @@
+#include "search_stats.hpp"
+#include "short_path.hpp"
+
+#include <cmath>
+
+const std::array<const char *, SearchHistogram::n_metrics>
+    SearchHistogram::metrics = {"settled", "scanned",   "pushed", "decreased",
+                                "init_us", "search_us", "trace_us"};
+
+namespace {
+/// \return bucket of value, 0 for values below 1 and b for [2^(b - 1), 2^b)
+int bucket_of(double value, int n_buckets) {
+    if (value < 1)
+        return 0;
+    return std::min(std::ilogb(value) + 1, n_buckets - 1);
+}
+} // namespace
+
+void SearchHistogram::add(const search_stats &stats) {
+    const std::array<double, n_metrics> values = {
+        double(stats.settled),  double(stats.scanned),
+        double(stats.pushed),   double(stats.decreased),
+        stats.us[search_stats::init], stats.us[search_stats::search],
+        stats.us[search_stats::trace]};
+
+    std::lock_guard<std::mutex> lock{mtx};
+    ++n_queries;
+    for (int m = 0; m < n_metrics; ++m) {
+        ++counts[m][bucket_of(values[m], n_buckets)];
+        sums[m] += values[m];
+    }
+}
+
+long SearchHistogram::queries() const {
+    std::lock_guard<std::mutex> lock{mtx};
+    return n_queries;
+}
+
+void SearchHistogram::dump(std::ostream &out, bool reset) {
+    std::lock_guard<std::mutex> lock{mtx};
+    out << "metric,queries,mean,lower,upper,count\n";
+    for (int m = 0; m < n_metrics; ++m) {
+        const double mean = n_queries ? sums[m] / n_queries : 0;
+        for (int b = 0; b < n_buckets; ++b)
+            if (counts[m][b] > 0)
+                out << metrics[m] << "," << n_queries << "," << mean << ","
+                    << (b == 0 ? 0 : 1l << (b - 1)) << "," << (1l << b) << ","
+                    << counts[m][b] << "\n";
+    }
+    if (reset) {
+        n_queries = 0;
+        counts = {};
+        sums = {};
+    }
+}
+
+void SearchHistogram::unit_testing() noexcept {
+    const Graph _g{200, 0.05, 42};
+    const CsrGraph csr = _g.freeze();
+    Dijkstra algo{_g};
+    SearchHistogram histogram;
+
+    // the counters should agree between the graph and its snapshot, and
+    // measuring should not change the paths found. the source is settled
+    // without being pushed
+    int mismatches = 0;
+    for (int v = 0; v < csr.order(); v += 3) {
+        const vertex_id from = csr.identity(0), to = csr.identity(v);
+        search_stats on_graph, on_csr;
+        const path expected = algo.find_path(from, to);
+        if (algo.find_path(from, to, &on_graph).cost() != expected.cost() or
+            Dijkstra::find_path(csr, from, to, Dijkstra::queue::heap, &on_csr)
+                    .cost() != expected.cost())
+            ++mismatches;
+        if (on_graph.settled != on_csr.settled or
+            on_graph.scanned != on_csr.scanned or
+            on_graph.pushed + 1 < on_graph.settled or on_graph.settled == 0)
+            ++mismatches;
+        histogram.add(on_graph);
+    }
+    std::cout << histogram.queries() << " queries measured, mismatches: "
+              << mismatches << "\n";
+    histogram.dump(std::cout, true);
+    histogram.dump(std::cout);
+}
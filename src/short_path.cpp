@@ -1,85 +1,483 @@
 #include "short_path.hpp"
 
-path::path(const std::map<vertex_id, vertex_id> &parent, vertex_id sink,
+#include <limits>
+#include <numeric>
+
+path::path(const Graph &g, const std::vector<int> &parent, int sink,
            int cost)
     : _cost(cost) {
     // keep back tracing until we reach the source eventually
-    for (vertex_id tmp = sink; tmp != -1; tmp = parent.at(tmp))
-        verts.push_back(tmp);
+    for (int tmp = sink; tmp != -1; tmp = parent[tmp])
+        verts.push_back(g.identity(tmp));
     verts.shrink_to_fit();
     // sink we have started with the sink
     std::reverse(itr_range(verts));
 }
 
+path::path(std::vector<vertex_id> vertices, int cost)
+    : verts(std::move(vertices)), _cost(cost) {}
+
 int path::cost() const { return _cost; }
 
 const std::vector<vertex_id> &path::vertices() const {
     return verts;
 }
 
-Dijkstra::Dijkstra(const Graph &graph) : g(graph) {}
-
-path Dijkstra::find_path(vertex_id source, vertex_id sink) {
-    const int inf = 1e6; // maximum distance is set to avoid overflow
-    std::map<vertex_id, int> dist;
-    std::map<vertex_id, vertex_id> parent;
-    PQ pq;
+path_tree::path_tree(std::vector<vertex_id> ids, std::vector<int> dist,
+                     std::vector<int> parent)
+    : ids(std::move(ids)), dist(std::move(dist)), parent(std::move(parent)),
+      by_id(this->ids.size()) {
+    std::iota(itr_range(by_id), 0);
+    std::sort(itr_range(by_id),
+              [this](int i, int j) { return this->ids[i] < this->ids[j]; });
+}
 
-    if (not g.has_vertex(source))
-        throw std::runtime_error("vertex " + std::to_string(source) +
-                                 " is not in the graph");
-    if (not g.has_vertex(sink))
-        throw std::runtime_error("vertex " + std::to_string(sink) +
+int path_tree::index(vertex_id u) const {
+    auto itr = std::lower_bound(
+        itr_range(by_id), u, [this](int i, vertex_id u) { return ids[i] < u; });
+    if (itr == std::end(by_id) or ids[*itr] != u)
+        throw std::runtime_error("vertex " + std::to_string(u) +
                                  " is not in the graph");
+    return *itr;
+}
+
+bool path_tree::reachable(vertex_id u) const { return dist[index(u)] != -1; }
+
+int path_tree::cost(vertex_id u) const {
+    if (not reachable(u))
+        throw std::out_of_range("no path to " + std::to_string(u));
+    return dist[index(u)];
+}
+
+path path_tree::path_to(vertex_id sink) const {
+    const int dst = index(sink);
+    if (dist[dst] == -1)
+        return {};
+
+    std::vector<vertex_id> verts;
+    for (int tmp = dst; tmp != -1; tmp = parent[tmp])
+        verts.push_back(ids[tmp]);
+    std::reverse(itr_range(verts));
+    return {std::move(verts), dist[dst]};
+}
 
-    for (const auto &vert : g.vertices()) {
-        dist[vert] = inf;  // assume all vertices are far far away
-        parent[vert] = -1; // assume all vertices are unreachable
-        pq.push(vert, inf);
+void Dijkstra::workspace::reset(int n) {
+    if (n > static_cast<int>(stamp.size()))
+        stamp.resize(n, 0), dist.resize(n), parent.resize(n);
+    if (++epoch == 0) { // stamps of 2^32 queries ago would look current
+        std::fill(itr_range(stamp), 0);
+        epoch = 1;
     }
+    heap.clear(), heap.reserve(n);
+}
+
+Dijkstra::workspace &Dijkstra::workspace::local(int slot) {
+    thread_local workspace spaces[2];
+    return spaces[slot];
+}
+
+Dijkstra::Dijkstra(const Graph &graph) : g(graph) {}
+
+namespace {
+/// \return dense index of u, throws if it is not in the graph
+int index_in(const Graph &g, vertex_id u) {
+    if (auto i = g.try_index(u))
+        return *i;
+    throw std::runtime_error("vertex " + std::to_string(u) +
+                             " is not in the graph");
+}
 
-    dist[source] = 0;                 // starting at the source
-    pq.change_priority(source, 0);    // which has the least priority
+/// \brief Dijkstra's algorithm on the graph, reporting to stats which is
+/// either a search_stats or a search_stats::none
+template <typename Stats>
+path graph_find_path(const Graph &g, int src, int dst, Stats &stats) {
+    stats.start();
+    auto &ws = Dijkstra::workspace::local(); // vertices not reached are far
+    auto &pq = ws.heap;                      // and unreachable
+    ws.reset(g.order());
+    stats.lap(search_stats::init);
+
+    ws.reach(src, 0, -1);             // starting at the source
+    pq.push(src, 0);                  // which has the least priority
     while (not pq.empty()) {          // while we still have vertices to check
         auto [vert, prio] = pq.top(); // take the vertex
         pq.pop();                     // remove it from the priority queue
-        if (vert == sink) // if we reach the sink no need to go further
+        stats.on_settle();
+        if (vert == dst) // if we reach the sink no need to go further
             break; // this would happen because it would have the least priority
-        for (const auto &nei : g.neighbors(vert)) { // traverse all neighbours
-            if (not pq.contains(nei)) // but only if they're still undiscovered
+        for (const auto &e : g.at(vert).out()) { // traverse all neighbours
+            const int nei = e.index();
+            const int alt = prio + e.weight(); // the alternative cost
+            stats.on_scan();
+            if (ws.reached(nei) and alt >= ws.distance(nei))
+                continue; // apply relaxation only if it's better
+            if (pq.contains(nei)) // change the priority accordingly
+                pq.change_priority(nei, alt), stats.on_decrease();
+            else // or discover it
+                pq.push(nei, alt), stats.on_push();
+            ws.reach(nei, alt, vert); // track which edge we took
+        }
+    }
+    stats.lap(search_stats::search);
+    if (not ws.reached(dst)) // if true then the sink is unreachable
+        return {};
+
+    path found{g, ws.parents(), dst, ws.distance(dst)}; // using the back trace
+    stats.lap(search_stats::trace);
+    return found;
+}
+} // namespace
+
+path Dijkstra::find_path(vertex_id source, vertex_id sink,
+                         search_stats *stats) {
+    const int src = index_in(g, source), dst = index_in(g, sink);
+    if (stats)
+        return graph_find_path(g, src, dst, *stats);
+    search_stats::none none;
+    return graph_find_path(g, src, dst, none);
+}
+
+path_tree Dijkstra::shortest_path_tree(vertex_id source) {
+    const auto &ws = settle(index_in(g, source), {});
+
+    // the tree covers every vertex, -1 for the ones never reached
+    std::vector<vertex_id> ids(g.order());
+    std::vector<int> dist(g.order(), -1), parent(g.order(), -1);
+    for (int i = 0; i < g.order(); ++i) {
+        ids[i] = g.identity(i);
+        if (ws.reached(i))
+            dist[i] = ws.distance(i), parent[i] = ws.parents()[i];
+    }
+    return {std::move(ids), std::move(dist), std::move(parent)};
+}
+
+const Dijkstra::workspace &
+Dijkstra::settle(int source, const std::vector<int> &sinks) const {
+    std::vector<int> wanted{sinks}; // sinks left to settle
+    std::sort(itr_range(wanted));
+    wanted.erase(std::unique(itr_range(wanted)), std::end(wanted));
+    int n_wanted = wanted.size();
+
+    auto &ws = workspace::local();
+    auto &pq = ws.heap;
+    ws.reset(g.order());
+
+    ws.reach(source, 0, -1);
+    pq.push(source, 0);
+    while (not pq.empty()) {
+        auto [vert, prio] = pq.top();
+        pq.pop();
+        if (n_wanted > 0 and std::binary_search(itr_range(wanted), vert) and
+            --n_wanted == 0)
+            break; // the paths to all sinks are known
+        for (const auto &e : g.at(vert).out()) {
+            const int nei = e.index(), alt = prio + e.weight();
+            if (ws.reached(nei) and alt >= ws.distance(nei))
+                continue;
+            if (pq.contains(nei))
+                pq.change_priority(nei, alt);
+            else
+                pq.push(nei, alt);
+            ws.reach(nei, alt, vert);
+        }
+    }
+    return ws;
+}
+
+std::vector<path> Dijkstra::find_paths(
+    const std::vector<std::pair<vertex_id, vertex_id>> &queries,
+    unsigned n_threads) {
+    ThreadPool pool{n_threads};
+    return find_paths(queries, pool);
+}
+
+std::vector<path> Dijkstra::find_paths(
+    const std::vector<std::pair<vertex_id, vertex_id>> &queries,
+    ThreadPool &pool) {
+    for (const auto &[source, sink] : queries)
+        for (const auto &u : {source, sink})
+            if (not g.has_vertex(u))
+                throw std::runtime_error("vertex " + std::to_string(u) +
+                                         " is not in the graph");
+
+    // query indices grouped by source, each group is one search
+    std::vector<int> order(queries.size());
+    std::iota(itr_range(order), 0);
+    std::stable_sort(itr_range(order), [&queries](int i, int j) {
+        return queries[i].first < queries[j].first;
+    });
+    std::vector<std::pair<int, int>> groups; // [begin, end) in order
+    for (unsigned i = 0; i < order.size(); ++i)
+        if (i == 0 or queries[order[i]].first != queries[order[i - 1]].first)
+            groups.emplace_back(i, i + 1);
+        else
+            groups.back().second = i + 1;
+
+    std::vector<path> paths(queries.size());
+    pool.run(groups.size(), [&](int group) {
+        const auto [begin, end] = groups[group];
+        std::vector<int> sinks;
+        for (int i = begin; i < end; ++i)
+            sinks.push_back(g.index(queries[order[i]].second));
+        const auto &ws = settle(g.index(queries[order[begin]].first), sinks);
+        for (int i = begin; i < end; ++i)
+            if (const int dst = sinks[i - begin]; ws.reached(dst))
+                paths[order[i]] = {g, ws.parents(), dst, ws.distance(dst)};
+    });
+    return paths;
+}
+
+path Dijkstra::find_path_lazy(vertex_id source, vertex_id sink) {
+    const int src = index_in(g, source), dst = index_in(g, sink);
+
+    // {distance, parent} of every reached vertex by dense index, absent ones
+    // are at infinity
+    std::unordered_map<int, std::pair<int, int>> reached;
+    // pairs of {distance, vertex}. the indexed PQ would allocate its position
+    // array over all vertices, so instead a vertex is pushed again on every
+    // improvement and stale entries are skipped when popped
+    std::priority_queue<std::pair<int, int>, std::vector<std::pair<int, int>>,
+                        std::greater<std::pair<int, int>>>
+        pq;
+
+    reached.emplace(src, std::make_pair(0, -1));
+    pq.emplace(0, src);
+    while (not pq.empty()) {
+        auto [prio, vert] = pq.top();
+        pq.pop();
+        if (prio != reached.at(vert).first) // stale entry, already settled
+            continue;
+        if (vert == dst)
+            break;
+        for (const auto &e : g.at(vert).out()) {
+            const int alt = prio + e.weight();
+            auto [itr, first_time] =
+                reached.emplace(e.index(), std::make_pair(alt, vert));
+            if (not first_time and alt >= itr->second.first)
                 continue;
-            // compute the alternative cost
-            const int alt = dist[vert] + g.weight({vert, nei});
-            if (alt < dist[nei]) {  // apply relaxation if the it's better
-                dist[nei] = alt;    // update the distance
-                parent[nei] = vert; // track which edge we took
-                pq.change_priority(nei, alt); // change the priority accordingly
+            itr->second = {alt, vert};
+            pq.emplace(alt, e.index());
+        }
+    }
+
+    auto itr = reached.find(dst);
+    if (itr == std::end(reached))
+        return {};
+
+    std::vector<vertex_id> verts;
+    for (int tmp = dst; tmp != -1; tmp = reached.at(tmp).second)
+        verts.push_back(g.identity(tmp));
+    std::reverse(itr_range(verts));
+    return {std::move(verts), itr->second.first};
+}
+
+namespace {
+/// \brief one direction of the bidirectional search, kept in a workspace of
+/// the thread
+struct frontier {
+    static constexpr int inf = std::numeric_limits<int>::max();
+    Dijkstra::workspace &ws;
+
+    frontier(Dijkstra::workspace &ws, int n, int root) : ws(ws) {
+        ws.reset(n);
+        ws.reach(root, 0, -1);
+        ws.heap.push(root, 0);
+    }
+
+    /// \return distance of the next vertex to settle, inf if exhausted
+    int top() const { return ws.heap.empty() ? inf : ws.heap.top().second; }
+
+    /// \return the distance of u, inf if it was not reached
+    int distance(int u) const { return ws.reached(u) ? ws.distance(u) : inf; }
+
+    /// \return true if u got a shorter distance
+    bool relax(int u, int parent, int alt) {
+        if (alt >= distance(u))
+            return false;
+        if (ws.heap.contains(u))
+            ws.heap.change_priority(u, alt);
+        else
+            ws.heap.push(u, alt);
+        ws.reach(u, alt, parent);
+        return true;
+    }
+
+    /// \brief appends the back trace from u to the root of the frontier
+    void trace(const Graph &g, int u, std::vector<vertex_id> &verts) const {
+        for (int tmp = u; tmp != -1; tmp = ws.parents()[tmp])
+            verts.push_back(g.identity(tmp));
+    }
+};
+} // namespace
+
+path Dijkstra::find_path_bidirectional(vertex_id source, vertex_id sink) {
+    const int inf = frontier::inf;
+    const int src = index_in(g, source), dst = index_in(g, sink);
+    frontier fwd{workspace::local(0), g.order(), src};
+    frontier bwd{workspace::local(1), g.order(), dst};
+    int best = src == dst ? 0 : inf; // shortest path seen so far
+    int meet = src;                  // where the frontiers of it met
+
+    // once the next vertices of both frontiers are further than the best path
+    // seen, no path through unsettled vertices can beat it. sums of distances
+    // are wide so that inf does not overflow
+    for (int f = fwd.top(), b = bwd.top(); (long long)f + b < best;
+         f = fwd.top(), b = bwd.top()) {
+        const bool forward = f <= b; // expand the closer frontier
+        auto &near = forward ? fwd : bwd;
+        const auto &far = forward ? bwd : fwd;
+
+        const auto [vert, prio] = near.ws.heap.top();
+        near.ws.heap.pop();
+        const auto relax = [&, prio = prio, vert = vert](int nei, int wei) {
+            const int alt = prio + wei;
+            const long long through = (long long)alt + far.distance(nei);
+            if (near.relax(nei, vert, alt) and through < best)
+                best = through, meet = nei;
+        };
+        // going backward, the reversed edges lead to the predecessors
+        for (const auto &e : forward ? g.at(vert).out() : g.at(vert).in())
+            relax(e.index(), e.weight());
+    }
+    if (best == inf)
+        return {};
+
+    std::vector<vertex_id> verts;
+    fwd.trace(g, meet, verts);
+    std::reverse(itr_range(verts));
+    verts.pop_back(); // the meeting vertex is the root of the backward trace
+    bwd.trace(g, meet, verts);
+    return {std::move(verts), best};
+}
+
+namespace {
+/// \brief Dijkstra's algorithm on a snapshot, generic over the priority queue
+/// which should provide the PQ interface, and over the stats as in
+/// graph_find_path(). the init phase is timed by the caller
+template <typename Queue, typename Stats>
+path csr_find_path(const CsrGraph &csr, int src, int dst,
+                   Dijkstra::workspace &ws, Queue &pq, Stats &stats) {
+    ws.reach(src, 0, -1);
+    pq.push(src, 0);
+    while (not pq.empty()) {
+        auto [vert, prio] = pq.top();
+        pq.pop();
+        stats.on_settle();
+        if (vert == dst)
+            break;
+        for (int e = csr.first(vert); e < csr.last(vert); ++e) {
+            const int nei = csr.target(e), alt = prio + csr.weight(e);
+            stats.on_scan();
+            if (not ws.reached(nei) or alt < ws.distance(nei)) {
+                // first time reached vertices enter the queue, the rest are
+                // still queued since settled ones cannot be improved
+                if (not ws.reached(nei))
+                    pq.push(nei, alt), stats.on_push();
+                else
+                    pq.change_priority(nei, alt), stats.on_decrease();
+                ws.reach(nei, alt, vert);
             }
         }
     }
-    if (dist[sink] == inf) // if true then the sink is unreachable
+    stats.lap(search_stats::search);
+    if (not ws.reached(dst))
         return {};
-    else // we construct the path using the back trace
-        return {parent, sink, dist[sink]};
+
+    std::vector<vertex_id> verts;
+    for (int tmp = dst; tmp != -1; tmp = ws.parents()[tmp])
+        verts.push_back(csr.identity(tmp));
+    std::reverse(itr_range(verts));
+    stats.lap(search_stats::trace);
+    return {std::move(verts), ws.distance(dst)};
+}
+} // namespace
+
+path Dijkstra::find_path(const CsrGraph &csr, vertex_id source,
+                         vertex_id sink, queue kind, search_stats *stats) {
+    const int src = csr.index(source), dst = csr.index(sink);
+
+    if (kind == queue::automatic)
+        kind = csr.min_weight() >= 0 and csr.max_weight() <= max_bucket_span
+                   ? queue::bucket
+                   : queue::heap;
+    const auto run = [&](auto &stats) {
+        stats.start();
+        auto &ws = workspace::local();
+        ws.reset(csr.order());
+        if (kind == queue::bucket) { // only sized for the searches using it
+            if (ws.buckets.span() != csr.max_weight())
+                ws.buckets = BucketPQ(csr.max_weight(), csr.order());
+            ws.buckets.clear(), ws.buckets.reserve(csr.order());
+        }
+        stats.lap(search_stats::init);
+        if (kind == queue::bucket)
+            return csr_find_path(csr, src, dst, ws, ws.buckets, stats);
+        else
+            return csr_find_path(csr, src, dst, ws, ws.heap, stats);
+    };
+    if (stats)
+        return run(*stats);
+    search_stats::none none;
+    return run(none);
 }
 
 void Dijkstra::unit_testing() noexcept {
     const auto test = [](double d) {
         Graph _g{50, d};
         Dijkstra algo{_g};
+        const CsrGraph csr = _g.freeze();
 
         auto &&verts = _g.vertices();
+        const path_tree tree = algo.shortest_path_tree(verts.front());
         std::pair<int, int> avg = {0, 0};
+        int mismatches = 0;
 
         for (unsigned j = 1; j < verts.size(); ++j)
-            if (path path = algo.find_path(verts.front(), verts[j]);
+            if (tree.reachable(verts[j]))
+                avg.first += tree.cost(verts[j]), avg.second++;
+
+        for (unsigned j = 1; j < verts.size(); ++j) {
+            path path = algo.find_path(verts.front(), verts[j]);
+            if (tree.path_to(verts[j]).cost() != path.cost())
+                ++mismatches;
+            for (auto kind : {queue::heap, queue::bucket})
+                if (find_path(csr, verts.front(), verts[j], kind).cost() !=
+                    path.cost())
+                    ++mismatches;
+            if (algo.find_path_lazy(verts.front(), verts[j]).cost() !=
                 path.cost())
-                avg.first += path.cost(), avg.second++;
+                ++mismatches;
+            if (algo.find_path_bidirectional(verts.front(), verts[j])
+                    .cost() != path.cost())
+                ++mismatches;
+        }
+
+        // every pair from a few sources, batched and shuffled
+        std::vector<std::pair<vertex_id, vertex_id>> queries;
+        for (unsigned i = 0; i < verts.size(); i += 10)
+            for (const auto &v : verts)
+                queries.emplace_back(verts[i], v);
+        std::shuffle(itr_range(queries), std::mt19937{});
+        const auto &paths = algo.find_paths(queries, 4);
+        for (unsigned i = 0; i < queries.size(); ++i)
+            if (paths[i].cost() !=
+                algo.find_path(queries[i].first, queries[i].second).cost())
+                ++mismatches;
         std::cout << "graph has " << verts.size() << " vertices and "
                   << _g.edges().size()
                   << " edges has path cost: " << (avg.first / avg.second)
-                  << "\n";
+                  << " (variant mismatches: " << mismatches << ")\n";
     };
 
     test(0.2), test(0.4);
+
+    // paths far costlier than any cap on distances
+    const int heavy = 4e8;
+    Graph _g{{{0, 0}, {1, 0}, {2, 0}, {3, 0}},
+             {{{0, 1}, heavy}, {{1, 2}, heavy}, {{2, 3}, heavy}}};
+    Dijkstra algo{_g};
+    std::cout << "heavy path cost: " << algo.find_path(0, 3).cost()
+              << ", bidirectional: "
+              << algo.find_path_bidirectional(0, 3).cost() << ", snapshot: "
+              << find_path(_g.freeze(), 0, 3).cost() << "\n";
 }
@@ -0,0 +1,83 @@
+#include "thread_pool.hpp"
+
+#include <algorithm>
+
+ThreadPool::ThreadPool(unsigned n_threads)
+    : ranges(std::max(n_threads, 1u)) {
+    for (unsigned id = 0; id < ranges.size(); ++id)
+        workers.emplace_back(&ThreadPool::work, this, id);
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto &worker : workers)
+        worker.join();
+}
+
+int ThreadPool::next_task(unsigned id) {
+    auto &own = ranges[id];
+    for (;;) {
+        {
+            std::lock_guard<std::mutex> lock(own.mtx);
+            if (own.begin < own.end)
+                return own.begin++;
+        }
+        // steal the upper half of the first non-empty range after ours
+        int begin = 0, end = 0;
+        for (unsigned i = 1; i < ranges.size() and begin == end; ++i) {
+            auto &victim = ranges[(id + i) % ranges.size()];
+            std::lock_guard<std::mutex> lock(victim.mtx);
+            end = victim.end;
+            begin = victim.end -= (victim.end - victim.begin + 1) / 2;
+        }
+        if (begin == end)
+            return -1;
+        std::lock_guard<std::mutex> lock(own.mtx);
+        own.begin = begin, own.end = end;
+    }
+}
+
+void ThreadPool::work(unsigned id) {
+    for (unsigned seen = 0;;) {
+        std::unique_lock<std::mutex> lock(mtx);
+        wake.wait(lock, [&] { return stopping or generation != seen; });
+        if (stopping)
+            return;
+        seen = generation;
+        lock.unlock();
+
+        for (int i; (i = next_task(id)) != -1;) {
+            try {
+                (*job)(i);
+            } catch (...) {
+                std::lock_guard<std::mutex> guard(mtx);
+                if (not error)
+                    error = std::current_exception();
+            }
+        }
+
+        lock.lock();
+        if (--running == 0)
+            done.notify_all();
+    }
+}
+
+void ThreadPool::run(int n, const std::function<void(int)> &task) {
+    std::unique_lock<std::mutex> lock(mtx);
+    job = &task, error = nullptr;
+    for (unsigned id = 0; id < ranges.size(); ++id) {
+        std::lock_guard<std::mutex> guard(ranges[id].mtx);
+        ranges[id].begin = std::size_t(n) * id / ranges.size();
+        ranges[id].end = std::size_t(n) * (id + 1) / ranges.size();
+    }
+    running = workers.size();
+    ++generation;
+    wake.notify_all();
+    done.wait(lock, [this] { return running == 0; });
+    if (error)
+        std::rethrow_exception(std::exchange(error, nullptr));
+}
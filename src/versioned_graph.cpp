@@ -0,0 +1,167 @@
+#include "versioned_graph.hpp"
+#include "graph_builder.hpp"
+#include "short_path.hpp"
+
+#include <climits>
+
+VersionedGraph::VersionedGraph(Graph graph, int max_readers)
+    : graph(std::move(graph)), slots(max_readers) {
+    publish();
+}
+
+VersionedGraph::~VersionedGraph() { delete current.load(); }
+
+void VersionedGraph::publish() {
+    const version *old = current.load();
+    const unsigned long number = old ? old->number + 1 : 0;
+    current.store(new version{graph.freeze(), number});
+    published.store(number);
+    if (not old)
+        return;
+
+    // a reader pinned after the epoch is bumped loads the new version, so the
+    // old one is only seen by those pinned at the epoch before or earlier
+    retired.emplace_back(epoch.fetch_add(1), old);
+    unsigned long oldest = ULONG_MAX;
+    for (const auto &s : slots)
+        if (const auto pinned = s.pinned.load())
+            oldest = std::min(oldest, pinned);
+    retired.erase(std::remove_if(std::begin(retired), std::end(retired),
+                                 [oldest](const auto &r) {
+                                     return r.first < oldest;
+                                 }),
+                  std::end(retired));
+}
+
+void VersionedGraph::rollback() {
+    const CsrGraph &csr = current.load()->graph;
+    GraphBuilder builder;
+    builder.reserve(csr.order(), csr.size());
+    for (int u = 0; u < csr.order(); ++u)
+        builder.add_vertex(csr.identity(u), csr.value(u));
+    for (int u = 0; u < csr.order(); ++u)
+        for (int e = csr.first(u); e < csr.last(u); ++e)
+            builder.add_edge({csr.identity(u), csr.identity(csr.target(e))},
+                             csr.weight(e));
+    graph = builder.build();
+}
+
+VersionedGraph::snapshot::snapshot(reader &owner, const version &ver)
+    : owner(&owner), ver(&ver) {}
+
+VersionedGraph::snapshot::snapshot(snapshot &&other) noexcept
+    : owner(std::exchange(other.owner, nullptr)), ver(other.ver) {}
+
+VersionedGraph::snapshot::~snapshot() {
+    if (owner and --owner->depth == 0)
+        owner->own.pinned.store(0);
+}
+
+VersionedGraph::reader::reader(VersionedGraph &graph)
+    : owner(graph), own([&graph]() -> slot & {
+          for (auto &s : graph.slots) {
+              bool taken = false;
+              if (s.taken.compare_exchange_strong(taken, true))
+                  return s;
+          }
+          throw std::runtime_error("too many readers of the graph");
+      }()) {}
+
+VersionedGraph::reader::~reader() { own.taken.store(false); }
+
+VersionedGraph::snapshot VersionedGraph::reader::read() {
+    // the epoch is published before the version is loaded, both sequentially
+    // consistent, so a writer either sees the pin or the reader the new one
+    if (depth++ == 0)
+        own.pinned.store(owner.epoch.load());
+    return snapshot{*this, *owner.current.load()};
+}
+
+void VersionedGraph::unit_testing() noexcept {
+    // every batch sets all the weights to the version number plus one, and
+    // odd versions have one more vertex hanging from the first
+    const int n_vertices = 200, n_updates = 300, n_readers = 3;
+    Graph _g{n_vertices, 0.05, {1, 1}, 42};
+    const vertex_id first = _g.vertices().front(),
+                    extra = _g.vertices().back() + 1;
+    VersionedGraph versioned{std::move(_g), n_readers + 1};
+
+    std::atomic<bool> done{false};
+    std::atomic<long> n_snapshots{0}, inconsistent{0};
+    const auto query = [&] {
+        reader own{versioned};
+        unsigned long last = 0;
+        while (not done.load()) {
+            const snapshot snap = own.read();
+            const CsrGraph &csr = snap.graph();
+            const edge_weight_t wei = snap.number() + 1;
+            bool consistent = snap.number() >= last and
+                              versioned.latest() >= snap.number() and
+                              csr.has_vertex(extra) == snap.number() % 2;
+            for (int e = 0; e < csr.size(); ++e)
+                consistent = consistent and csr.weight(e) == wei;
+            const path p = Dijkstra::find_path(csr, first, csr.identity(1));
+            consistent = consistent and p.cost() % wei == 0;
+            {
+                const snapshot nested = own.read();
+                consistent = consistent and nested.number() >= snap.number();
+            }
+            inconsistent += not consistent;
+            ++n_snapshots;
+            last = snap.number();
+        }
+    };
+    std::vector<std::thread> readers;
+    for (int i = 0; i < n_readers; ++i)
+        readers.emplace_back(query);
+
+    for (int i = 0; i < n_updates; ++i)
+        versioned.update([&versioned, first, extra](Graph &g) {
+            const unsigned long number = versioned.latest() + 1;
+            for (const auto &e : g.edges())
+                g.weight(e, number + 1);
+            if (number % 2) {
+                g.add_vertex(extra, 0);
+                g.add_edge({first, extra}, number + 1);
+            } else
+                g.remove_vertex(extra);
+        });
+    done = true;
+    for (auto &t : readers)
+        t.join();
+
+    // a batch failing half way is neither published nor kept for the next
+    const unsigned long before = versioned.latest();
+    try {
+        versioned.update([first](Graph &g) {
+            for (const auto &e : g.edges())
+                g.weight(e, 0);
+            g.add_vertex(first, 0);
+        });
+    } catch (const std::runtime_error &e) {
+        std::cout << e.what() << "\n";
+    }
+
+    // with the readers gone, the next update frees every version retired
+    versioned.update([](Graph &) {});
+    bool rolled_back = versioned.latest() == before + 1;
+    {
+        reader own{versioned};
+        const snapshot snap = own.read();
+        const edge_weight_t wei = before + 1;
+        for (int e = 0; e < snap.graph().size(); ++e)
+            rolled_back = rolled_back and snap.graph().weight(e) == wei;
+    }
+    std::cout << versioned.latest() << " versions published, "
+              << n_snapshots << " snapshots read, inconsistent: "
+              << inconsistent << ", retired left: "
+              << versioned.retired.size() << ", rolled back: " << rolled_back
+              << "\n";
+
+    reader one{versioned}, two{versioned}, three{versioned}, four{versioned};
+    try {
+        reader five{versioned};
+    } catch (const std::runtime_error &e) {
+        std::cout << e.what() << "\n";
+    }
+}
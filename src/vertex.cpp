@@ -1,20 +1,37 @@
 #include "graph.hpp"
 
+namespace {
+/// \brief first edge of a sorted list not going to a vertex below v
+template <typename List> auto find(List &list, vertex_id v) {
+    return std::lower_bound(
+        itr_range(list), v,
+        [](const Edge &e, vertex_id v) { return e.to() < v; });
+}
+} // namespace
+
 Vertex::Vertex(vertex_id id, const vertex_value_t &val) : _id(id), _val(val) {}
 
 std::vector<std::pair<vertex_id, vertex_id>> Vertex::edges() const {
     std::vector<std::pair<vertex_id, vertex_id>> vec;
     vec.reserve(_edges.size());
-    for (const auto &[nei, _] : _edges)
-        vec.emplace_back(_id, nei);
+    for (const auto &e : _edges)
+        vec.emplace_back(_id, e.to());
     return vec;
 }
 
 std::vector<vertex_id> Vertex::neighbors() const {
     std::vector<vertex_id> vec;
     vec.reserve(_edges.size());
-    for (const auto &[nei, _] : _edges)
-        vec.emplace_back(nei);
+    for (const auto &e : _edges)
+        vec.emplace_back(e.to());
+    return vec;
+}
+
+std::vector<vertex_id> Vertex::predecessors() const {
+    std::vector<vertex_id> vec;
+    vec.reserve(_in.size());
+    for (const auto &e : _in)
+        vec.emplace_back(e.to());
     return vec;
 }
 
@@ -22,35 +39,61 @@ vertex_id Vertex::identity() const { return _id; }
 const vertex_value_t &Vertex::value() const { return _val; }
 void Vertex::value(const vertex_value_t &val) { _val = val; }
 
-const edge_ptr &Vertex::edge(vertex_pref v) const {
-    return _edges.at(v->_id);
+bool Vertex::adjacent(vertex_id v) const { return edge(v) != nullptr; }
+
+const Edge *Vertex::edge(vertex_id v) const {
+    auto itr = find(_edges, v);
+    return itr != std::end(_edges) and itr->to() == v ? &*itr : nullptr;
 }
 
-bool Vertex::adjacent(vertex_pref v) const {
-    return _edges.find(v->_id) != std::end(_edges);
+Edge *Vertex::edge(vertex_id v) {
+    return const_cast<Edge *>(std::as_const(*this).edge(v));
 }
 
-void Vertex::add_directed_edge(vertex_pref v, const edge_weight_t &wei) {
-    if (adjacent(v))
-        return;
-    _edges.emplace(v->_id, std::make_unique<Edge>(shared_from_this(), v, wei));
+Edge *Vertex::edge_from(vertex_id u) {
+    auto itr = find(_in, u);
+    return itr != std::end(_in) and itr->to() == u ? &*itr : nullptr;
+}
+
+void Vertex::reserve(int n_out, int n_in) {
+    _edges.reserve(n_out);
+    _in.reserve(n_in);
+}
+
+bool Vertex::add_out(const Edge &e) {
+    auto itr = find(_edges, e.to());
+    if (itr != std::end(_edges) and itr->to() == e.to())
+        return false;
+    _edges.insert(itr, e);
+    return true;
+}
+
+void Vertex::append_out(const Edge &e) { _edges.push_back(e); }
+
+void Vertex::add_in(vertex_id u, int index, const edge_weight_t &wei) {
+    _in.insert(find(_in, u), {u, index, wei});
 }
 
-void Vertex::add_edge(vertex_pref v, const edge_weight_t &wei) {
-    add_edge(v, wei, wei);
+void Vertex::append_in(vertex_id u, int index, const edge_weight_t &wei) {
+    _in.emplace_back(u, index, wei);
 }
 
-void Vertex::add_edge(vertex_pref v, const edge_weight_t &wei,
-                             const edge_weight_t &re_wei) {
-    add_directed_edge(v, wei);
-    v->add_directed_edge(shared_from_this(), re_wei);
+bool Vertex::remove_out(vertex_id v) {
+    auto itr = find(_edges, v);
+    if (itr == std::end(_edges) or itr->to() != v)
+        return false;
+    _edges.erase(itr);
+    return true;
 }
 
-void Vertex::remove_directed_edge(vertex_pref v) {
-    _edges.erase(v->_id);
+void Vertex::remove_in(vertex_id u) {
+    if (auto e = edge_from(u))
+        _in.erase(std::begin(_in) + (e - _in.data()));
 }
 
-void Vertex::remove_edge(vertex_pref v) {
-    remove_directed_edge(v);
-    v->remove_directed_edge(shared_from_this());
+void Vertex::relocate(vertex_id u, int index) {
+    if (auto e = edge(u))
+        e->index(index);
+    if (auto e = edge_from(u))
+        e->index(index);
 }